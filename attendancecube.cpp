@@ -0,0 +1,238 @@
+#include "attendancecube.h"
+#include <QLocale>
+#include <QStringList>
+#include <QtConcurrent>
+#include <cmath>
+
+// QuantileSketch implementation
+QuantileSketch::QuantileSketch(double relativeAccuracy)
+    : m_gamma((1.0 + relativeAccuracy) / (1.0 - relativeAccuracy)),
+      m_logGamma(std::log(m_gamma)),
+      m_zeroCount(0),
+      m_count(0)
+{
+}
+
+int QuantileSketch::bucketFor(double value) const
+{
+    return int(std::ceil(std::log(value) / m_logGamma));
+}
+
+double QuantileSketch::bucketValue(int bucket) const
+{
+    // Midpoint with the same relative error on both bucket edges
+    return 2.0 * std::pow(m_gamma, bucket) / (m_gamma + 1.0);
+}
+
+void QuantileSketch::add(double value, qint64 count)
+{
+    if (count <= 0)
+        return;
+    if (value <= 0.0)
+        m_zeroCount += count;
+    else
+        m_buckets[bucketFor(value)] += count;
+    m_count += count;
+}
+
+void QuantileSketch::merge(const QuantileSketch &other)
+{
+    // Both sketches use the same accuracy, so buckets line up
+    m_zeroCount += other.m_zeroCount;
+    m_count += other.m_count;
+    for (auto it = other.m_buckets.cbegin(); it != other.m_buckets.cend(); ++it)
+        m_buckets[it.key()] += it.value();
+}
+
+double QuantileSketch::quantile(double q) const
+{
+    if (m_count == 0)
+        return 0.0;
+
+    double rank = qBound(0.0, q, 1.0) * (m_count - 1);
+    qint64 seen = m_zeroCount;
+    if (seen > rank)
+        return 0.0;
+    for (auto it = m_buckets.cbegin(); it != m_buckets.cend(); ++it) {
+        seen += it.value();
+        if (seen > rank)
+            return bucketValue(it.key());
+    }
+    return m_buckets.isEmpty() ? 0.0 : bucketValue(m_buckets.lastKey());
+}
+
+// CubeCell implementation
+void CubeCell::add(const Match &match)
+{
+    matches++;
+    if (!match.hasSpectateurs())
+        return;
+
+    if (attendanceCount == 0) {
+        minimum = match.spectateurs;
+        maximum = match.spectateurs;
+    } else {
+        minimum = qMin(minimum, match.spectateurs);
+        maximum = qMax(maximum, match.spectateurs);
+    }
+    attendanceCount++;
+    attendanceSum += match.spectateurs;
+    sketch.add(match.spectateurs);
+
+    if (match.date.isValid()) {
+        QDate day = match.date.date();
+        QPair<qint64, qint64> &month = monthly[day.year() * 12 + day.month() - 1];
+        month.first += match.spectateurs;
+        month.second++;
+    }
+}
+
+void CubeCell::merge(const CubeCell &other)
+{
+    if (other.attendanceCount > 0) {
+        if (attendanceCount == 0) {
+            minimum = other.minimum;
+            maximum = other.maximum;
+        } else {
+            minimum = qMin(minimum, other.minimum);
+            maximum = qMax(maximum, other.maximum);
+        }
+    }
+    matches += other.matches;
+    attendanceCount += other.attendanceCount;
+    attendanceSum += other.attendanceSum;
+    sketch.merge(other.sketch);
+    for (auto it = other.monthly.cbegin(); it != other.monthly.cend(); ++it) {
+        QPair<qint64, qint64> &month = monthly[it.key()];
+        month.first += it->first;
+        month.second += it->second;
+    }
+}
+
+double CubeCell::trendPerMonth() const
+{
+    if (monthly.size() < 2)
+        return 0.0;
+
+    // Least-squares slope of the monthly average attendance
+    double n = monthly.size();
+    double sumX = 0, sumY = 0, sumXY = 0, sumXX = 0;
+    for (auto it = monthly.cbegin(); it != monthly.cend(); ++it) {
+        double x = it.key();
+        double y = double(it->first) / it->second;
+        sumX += x;
+        sumY += y;
+        sumXY += x * y;
+        sumXX += x * x;
+    }
+    double denominator = n * sumXX - sumX * sumX;
+    if (qFuzzyIsNull(denominator))
+        return 0.0;
+    return (n * sumXY - sumX * sumY) / denominator;
+}
+
+// AttendanceCube implementation
+QString AttendanceCube::dimensionName(Dimension dimension)
+{
+    switch (dimension) {
+    case Venue: return "Lieu";
+    case Month: return "Month";
+    case Weekday: return "Weekday";
+    case Status: return "Status";
+    case Type: return "Type";
+    case Day: return "Day";
+    }
+    return QString();
+}
+
+QString AttendanceCube::keyFor(const Match &match, Dimension dimension)
+{
+    QString key;
+    switch (dimension) {
+    case Venue:
+        key = match.lieu.trimmed();
+        break;
+    case Month:
+        if (match.date.isValid())
+            key = match.date.toString("yyyy-MM");
+        break;
+    case Weekday:
+        if (match.date.isValid()) {
+            int day = match.date.date().dayOfWeek();
+            // Prefix with the ISO day number so keys sort Monday to Sunday
+            key = QString("%1 %2").arg(day).arg(QLocale().dayName(day));
+        }
+        break;
+    case Status:
+        key = match.status.trimmed();
+        break;
+    case Type:
+        key = match.type.trimmed();
+        break;
+    case Day:
+        if (match.date.isValid())
+            key = match.date.toString("yyyy-MM-dd");
+        break;
+    }
+    return key.isEmpty() ? QString("(none)") : key;
+}
+
+QString AttendanceCube::keyFor(const Match &match, const QList<Dimension> &dimensions)
+{
+    if (dimensions.size() == 1)
+        return keyFor(match, dimensions.first());
+    QStringList values;
+    for (Dimension dimension : dimensions)
+        values << keyFor(match, dimension);
+    return values.join(" / ");
+}
+
+QHash<QString, CubeCell> AttendanceCube::rollup(const QVector<Match> &matches, Dimension groupBy,
+                                                const Filter &filter)
+{
+    return rollup(matches, QList<Dimension>{groupBy}, filter);
+}
+
+QHash<QString, CubeCell> AttendanceCube::rollup(const QVector<Match> &matches, const QList<Dimension> &groupBy,
+                                                const Filter &filter)
+{
+    using Rollup = QHash<QString, CubeCell>;
+    const int chunkSize = 16384;
+
+    QVector<QPair<int, int>> chunks;
+    for (int begin = 0; begin < matches.size(); begin += chunkSize)
+        chunks.append(qMakePair(begin, qMin<int>(begin + chunkSize, matches.size())));
+
+    auto rollupChunk = [&matches, &groupBy, &filter](const QPair<int, int> &chunk) {
+        Rollup partial;
+        for (int i = chunk.first; i < chunk.second; ++i) {
+            const Match &match = matches[i];
+            bool accepted = true;
+            for (const auto &criterion : filter) {
+                if (keyFor(match, criterion.first) != criterion.second) {
+                    accepted = false;
+                    break;
+                }
+            }
+            if (accepted)
+                partial[keyFor(match, groupBy)].add(match);
+        }
+        return partial;
+    };
+
+    auto mergeChunk = [](Rollup &result, const Rollup &partial) {
+        for (auto it = partial.cbegin(); it != partial.cend(); ++it)
+            result[it.key()].merge(it.value());
+    };
+
+    // Small inputs are not worth the thread hand-off
+    if (chunks.size() <= 1) {
+        Rollup result;
+        if (!chunks.isEmpty())
+            mergeChunk(result, rollupChunk(chunks.first()));
+        return result;
+    }
+
+    return QtConcurrent::blockingMappedReduced<Rollup>(chunks, rollupChunk, mergeChunk,
+                                                       QtConcurrent::UnorderedReduce);
+}
@@ -0,0 +1,82 @@
+#ifndef ATTENDANCECUBE_H
+#define ATTENDANCECUBE_H
+
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QPair>
+#include <QString>
+#include <QVector>
+#include "matches.h"
+
+// Mergeable quantile sketch with relative-error guarantees (DDSketch style):
+// values fall into logarithmic buckets, so two sketches merge by adding counts.
+class QuantileSketch
+{
+public:
+    explicit QuantileSketch(double relativeAccuracy = 0.01);
+
+    void add(double value, qint64 count = 1);
+    void merge(const QuantileSketch &other);
+    double quantile(double q) const; // q in [0, 1]
+    qint64 count() const { return m_count; }
+
+private:
+    int bucketFor(double value) const;
+    double bucketValue(int bucket) const;
+
+    double m_gamma;
+    double m_logGamma;
+    qint64 m_zeroCount;
+    qint64 m_count;
+    QMap<int, qint64> m_buckets;
+};
+
+// Attendance rollup for one slice of the cube
+struct CubeCell
+{
+    qint64 matches = 0;
+    qint64 attendanceCount = 0;
+    qint64 attendanceSum = 0;
+    int minimum = 0;
+    int maximum = 0;
+    QuantileSketch sketch;
+    QMap<int, QPair<qint64, qint64>> monthly; // yyyy*12+month -> (sum, count), for trends
+
+    void add(const Match &match);
+    void merge(const CubeCell &other);
+    double average() const { return attendanceCount > 0 ? double(attendanceSum) / attendanceCount : 0.0; }
+    double median() const { return sketch.quantile(0.5); }
+    double p90() const { return sketch.quantile(0.9); }
+    double trendPerMonth() const; // least-squares slope of the monthly averages
+};
+
+// Multi-dimensional attendance analytics over cached matches
+class AttendanceCube
+{
+public:
+    enum Dimension {
+        Venue,
+        Month,
+        Weekday,
+        Status,
+        Type,
+        Day
+    };
+
+    using Filter = QList<QPair<Dimension, QString>>;
+
+    static QString dimensionName(Dimension dimension);
+    static QString keyFor(const Match &match, Dimension dimension);
+    static QString keyFor(const Match &match, const QList<Dimension> &dimensions); // joined with " / "
+
+    // Groups matches passing every filter by the given dimension. Work is
+    // split in chunks that are rolled up in parallel and merged.
+    static QHash<QString, CubeCell> rollup(const QVector<Match> &matches, Dimension groupBy,
+                                           const Filter &filter = Filter());
+    // Same, grouped by several dimensions at once; keys are joined with " / "
+    static QHash<QString, CubeCell> rollup(const QVector<Match> &matches, const QList<Dimension> &groupBy,
+                                           const Filter &filter = Filter());
+};
+
+#endif // ATTENDANCECUBE_H
@@ -0,0 +1,152 @@
+#include "attendancestats.h"
+#include "connection.h"
+#include <QDebug>
+#include <QSet>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace {
+
+const char *reconcileConnection = "proball_reconcile";
+
+} // namespace
+
+AttendanceAggregates::AttendanceAggregates(MatchStore *store, QObject *parent)
+    : QObject(parent), m_store(store), m_reconcileVersion(0), m_loaded(false)
+{
+    if (!m_store)
+        return;
+
+    // Pick up edits made elsewhere; the drift log in rebuild() reports them
+    m_reconcileTimer.setInterval(5 * 60 * 1000);
+    connect(&m_reconcileTimer, &QTimer::timeout, this, &AttendanceAggregates::reconcile);
+    connect(&m_reconcileWatcher, &QFutureWatcher<ReconcileLoad>::finished, this, [this]() {
+        const ReconcileLoad load = m_reconcileWatcher.result();
+        // A local edit or reload during the read may be newer than what was read
+        if (!load.loaded || m_store->version() != m_reconcileVersion)
+            return;
+        m_store->setMatches(load.matches);
+    });
+    m_reconcileTimer.start();
+
+    connect(m_store, &MatchStore::reloaded, this, [this]() { rebuild(m_store->matches()); });
+    connect(m_store, &MatchStore::matchInserted, this, &AttendanceAggregates::matchInserted);
+    connect(m_store, &MatchStore::matchUpdated, this, &AttendanceAggregates::matchUpdated);
+    connect(m_store, &MatchStore::matchRemoved, this, &AttendanceAggregates::matchRemoved);
+    if (m_store->version() > 0)
+        rebuild(m_store->matches());
+}
+
+void AttendanceAggregates::rebuild(const QVector<Match> &matches)
+{
+    const QHash<QString, TypeAttendance> previous = m_types;
+    m_types.clear();
+    for (const Match &match : matches)
+        adjust(match, +1);
+
+    if (m_loaded) {
+        // Report drift, including types that appeared or vanished, so missed updates show in the logs
+        QSet<QString> types(m_types.keyBegin(), m_types.keyEnd());
+        types.unite(QSet<QString>(previous.keyBegin(), previous.keyEnd()));
+        for (const QString &type : std::as_const(types)) {
+            const TypeAttendance cached = previous.value(type);
+            const TypeAttendance fresh = m_types.value(type);
+            if (cached.matchCount != fresh.matchCount || cached.attendanceSum != fresh.attendanceSum)
+                qDebug() << "Attendance aggregates drifted for" << type << "- corrected";
+        }
+    }
+
+    m_loaded = true;
+    emit rebuilt();
+}
+
+void AttendanceAggregates::setReconcileInterval(int ms)
+{
+    m_reconcileTimer.setInterval(ms);
+}
+
+// Runs on a pool thread, through a private connection: connections cannot
+// be shared with the GUI thread
+AttendanceAggregates::ReconcileLoad AttendanceAggregates::loadForReconcile()
+{
+    ReconcileLoad result;
+    {
+        Connection connection;
+        if (!connection.createconnect(QLatin1String(reconcileConnection))) {
+            qDebug() << "Attendance reconcile could not connect";
+        } else {
+            QSqlDatabase db = QSqlDatabase::database(QLatin1String(reconcileConnection), false);
+            QString error;
+            result.loaded = MatchStore::loadAll(db, result.matches, &error);
+            if (!result.loaded)
+                qDebug() << "Attendance reconcile failed:" << error;
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(QLatin1String(reconcileConnection));
+    return result;
+}
+
+void AttendanceAggregates::reconcile()
+{
+    // Nothing to check before the first load, and one reload at a time
+    if (m_store->version() == 0 || m_reconcileWatcher.isRunning())
+        return;
+    m_reconcileVersion = m_store->version();
+    m_reconcileWatcher.setFuture(QtConcurrent::run(&AttendanceAggregates::loadForReconcile));
+}
+
+void AttendanceAggregates::adjust(const Match &match, int delta)
+{
+    TypeAttendance &entry = m_types[match.type];
+    entry.type = match.type;
+    entry.matchCount += delta;
+
+    // Non-numeric SPECTATEURS are ignored, like TO_NUMBER NULLs
+    if (match.hasSpectateurs()) {
+        entry.attendanceCount += delta;
+        entry.attendanceSum += qint64(match.spectateurs) * delta;
+        int &occurrences = entry.values[match.spectateurs];
+        occurrences += delta;
+        if (occurrences <= 0)
+            entry.values.remove(match.spectateurs);
+    }
+
+    if (entry.matchCount <= 0)
+        m_types.remove(match.type);
+}
+
+void AttendanceAggregates::matchInserted(const Match &match)
+{
+    adjust(match, +1);
+    emit changed(match.type);
+}
+
+void AttendanceAggregates::matchUpdated(const Match &before, const Match &after)
+{
+    adjust(before, -1);
+    adjust(after, +1);
+    emit changed(before.type);
+    if (after.type != before.type)
+        emit changed(after.type);
+}
+
+void AttendanceAggregates::matchRemoved(const Match &match)
+{
+    adjust(match, -1);
+    emit changed(match.type);
+}
+
+QList<TypeAttendance> AttendanceAggregates::byType() const
+{
+    QList<TypeAttendance> result = m_types.values();
+    std::sort(result.begin(), result.end(), [](const TypeAttendance &a, const TypeAttendance &b) {
+        return a.type < b.type;
+    });
+    return result;
+}
+
+TypeAttendance AttendanceAggregates::forType(const QString &type) const
+{
+    return m_types.value(type);
+}
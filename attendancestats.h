@@ -0,0 +1,71 @@
+#ifndef ATTENDANCESTATS_H
+#define ATTENDANCESTATS_H
+
+#include <QObject>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QMap>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+#include "matches.h"
+
+// Running attendance totals for one TYPEMATCH value
+struct TypeAttendance
+{
+    QString type;
+    qint64 matchCount = 0;      // COUNT(*)
+    qint64 attendanceCount = 0; // rows with a numeric SPECTATEURS
+    qint64 attendanceSum = 0;
+    QMap<int, int> values;      // SPECTATEURS value -> occurrences, keeps min/max exact on delete
+
+    double average() const { return attendanceCount > 0 ? double(attendanceSum) / attendanceCount : 0.0; }
+    int minimum() const { return values.isEmpty() ? 0 : values.firstKey(); }
+    int maximum() const { return values.isEmpty() ? 0 : values.lastKey(); }
+};
+
+// Per-TYPEMATCH attendance aggregates kept in memory. Derived from the
+// MatchStore: rebuilt when it reloads and adjusted on each insert, update
+// and delete it reports. Every 5 minutes the table is re-read on a worker
+// thread and handed to the store, so edits made by other clients show up
+// and any drift is logged when the aggregates are rebuilt.
+class AttendanceAggregates : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AttendanceAggregates(MatchStore *store, QObject *parent = nullptr);
+
+    void rebuild(const QVector<Match> &matches);
+    void setReconcileInterval(int ms);
+
+    QList<TypeAttendance> byType() const; // ordered by type
+    TypeAttendance forType(const QString &type) const;
+
+signals:
+    void changed(const QString &type);
+    void rebuilt();
+
+private:
+    // What the reconcile worker hands back to the GUI thread
+    struct ReconcileLoad
+    {
+        bool loaded = false;
+        QVector<Match> matches;
+    };
+
+    static ReconcileLoad loadForReconcile();
+    void adjust(const Match &match, int delta);
+    void matchInserted(const Match &match);
+    void matchUpdated(const Match &before, const Match &after);
+    void matchRemoved(const Match &match);
+    void reconcile();
+
+    MatchStore *m_store;
+    QTimer m_reconcileTimer;
+    QFutureWatcher<ReconcileLoad> m_reconcileWatcher;
+    quint64 m_reconcileVersion; // store version when the running reload started
+    QHash<QString, TypeAttendance> m_types;
+    bool m_loaded;
+};
+
+#endif // ATTENDANCESTATS_H
@@ -0,0 +1,484 @@
+#include "barrierlink.h"
+#include "trace.h"
+#include <QDebug>
+
+namespace {
+
+const int writeTimeoutMs = 1000;
+const int ackTimeoutMs = 150;
+const int helloTimeoutMs = 400;
+const int maxAttempts = 5;
+const int helloAttempts = 3;
+// Arduino-class boards reset when the port opens (DTR) and sit in their
+// bootloader for one to two seconds; a Hello sent earlier is never seen
+const int settleMs = 2000;
+const int windowSize = 4;
+const int minBackoffMs = 500;
+const int maxBackoffMs = 30000;
+
+} // namespace
+
+using namespace BarrierProtocol;
+
+// BarrierWorker implementation
+BarrierWorker::BarrierWorker(const QString &portName, const QString &fallbackId, bool allowLegacy,
+                             std::shared_ptr<TelemetryRing> telemetry)
+    : m_portName(portName), m_fallbackId(fallbackId), m_allowLegacy(allowLegacy), m_port(nullptr), m_writeTimer(nullptr), m_retransmitTimer(nullptr), m_reconnectTimer(nullptr),
+      m_settleTimer(nullptr), m_backoffMs(minBackoffMs), m_version(-1), m_nextSeq(0), m_helloSeq(-1), m_bytesLeft(0), m_lastCapacity(-1),
+      m_telemetry(std::move(telemetry)), m_haveTelemetrySeq(false), m_telemetrySeq(0)
+{
+}
+
+BarrierWorker::~BarrierWorker()
+{
+    // Runs on the barrier thread as it finishes
+    if (m_port && m_port->isOpen())
+        m_port->close();
+}
+
+void BarrierWorker::start()
+{
+    // Created here so that they belong to the barrier thread
+    m_port = new QSerialPort(this);
+    connect(m_port, &QSerialPort::readyRead, this, &BarrierWorker::readIncoming);
+    connect(m_port, &QSerialPort::bytesWritten, this, &BarrierWorker::bytesWritten);
+    connect(m_port, &QSerialPort::errorOccurred, this, &BarrierWorker::portError);
+
+    m_writeTimer = new QTimer(this);
+    m_writeTimer->setSingleShot(true);
+    m_writeTimer->setInterval(writeTimeoutMs);
+    connect(m_writeTimer, &QTimer::timeout, this, &BarrierWorker::writeTimedOut);
+
+    // Coarse tick; only runs while frames are waiting for an ack
+    m_retransmitTimer = new QTimer(this);
+    m_retransmitTimer->setInterval(ackTimeoutMs / 3);
+    m_retransmitTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_retransmitTimer, &QTimer::timeout, this, &BarrierWorker::checkRetransmits);
+
+    m_reconnectTimer = new QTimer(this);
+    m_reconnectTimer->setSingleShot(true);
+    connect(m_reconnectTimer, &QTimer::timeout, this, &BarrierWorker::reconnect);
+
+    m_settleTimer = new QTimer(this);
+    m_settleTimer->setSingleShot(true);
+    m_settleTimer->setInterval(settleMs);
+    connect(m_settleTimer, &QTimer::timeout, this, &BarrierWorker::sendHello);
+
+    reconnect();
+}
+
+bool BarrierWorker::openPort()
+{
+    // The gate manager picked the port; just configure and open it
+    m_port->setPortName(m_portName);
+    m_port->setBaudRate(QSerialPort::Baud9600);
+    m_port->setDataBits(QSerialPort::Data8);
+    m_port->setParity(QSerialPort::NoParity);
+    m_port->setStopBits(QSerialPort::OneStop);
+    m_port->setFlowControl(QSerialPort::NoFlowControl);
+
+    if (!m_port->open(QIODevice::ReadWrite)) {
+        qDebug() << "Failed to open gate serial port" << m_portName << "Error:" << m_port->errorString();
+        return false;
+    }
+    qDebug() << "Connected to gate controller on" << m_portName;
+    return true;
+}
+
+void BarrierWorker::reconnect()
+{
+    if (m_port->isOpen())
+        return;
+
+    if (!openPort()) {
+        scheduleReconnect();
+        return;
+    }
+
+    m_lastCapacity = -1; // the barrier may have restarted
+    m_version = -1;
+    m_helloSeq = -1;
+    m_bytesLeft = 0;
+    m_decoder.clear();
+    m_haveTelemetrySeq = false;
+    emit connectionChanged(true, m_port->portName());
+
+    // Let the board come out of its bootloader before saying Hello
+    m_settleTimer->start();
+}
+
+void BarrierWorker::sendHello()
+{
+    if (!m_port->isOpen())
+        return;
+
+    // Whatever the bootloader printed is not ours
+    m_port->clear(QSerialPort::Input);
+    m_decoder.clear();
+
+    // Find out which protocol the barrier speaks before sending commands
+    m_helloSeq = m_nextSeq;
+    Outstanding hello{{Command::Hello, 0}, helloFrame(m_nextSeq++), 0, {}, {}};
+    m_outstanding.prepend(hello);
+    sendFrame(m_outstanding.first());
+}
+
+void BarrierWorker::scheduleReconnect()
+{
+    if (m_reconnectTimer->isActive())
+        return;
+    m_reconnectTimer->start(m_backoffMs);
+    m_backoffMs = qMin(m_backoffMs * 2, maxBackoffMs);
+}
+
+void BarrierWorker::requeue(const Command &command)
+{
+    if (command.kind == Command::Hello)
+        return;
+
+    // Keep only the newest capacity and a single reset
+    for (const Command &queued : std::as_const(m_queue)) {
+        if (queued.kind == command.kind)
+            return;
+    }
+    m_queue.prepend(command);
+}
+
+void BarrierWorker::dropConnection(const QString &reason)
+{
+    qDebug() << "Barrier link lost:" << reason;
+    emit errorOccurred(reason);
+
+    // Unacknowledged commands go back to the queue, newest first
+    for (int i = m_outstanding.size() - 1; i >= 0; --i)
+        requeue(m_outstanding[i].command);
+    m_outstanding.clear();
+    m_retransmitTimer->stop();
+    m_writeTimer->stop();
+    m_settleTimer->stop();
+    m_bytesLeft = 0;
+
+    const bool wasOpen = m_port->isOpen();
+    m_port->close();
+    if (wasOpen)
+        emit connectionChanged(false, m_port->portName());
+    scheduleReconnect();
+}
+
+void BarrierWorker::enqueueCapacity(int capacity)
+{
+    // Last write wins: an unsent capacity is stale as soon as a new one arrives
+    for (int i = m_queue.size() - 1; i >= 0; --i) {
+        if (m_queue[i].kind == Command::Capacity)
+            m_queue.removeAt(i);
+    }
+
+    // Nothing to send if the barrier already has this capacity, but still
+    // confirm it so callers waiting for this value are not left hanging
+    bool pending = !m_queue.isEmpty();
+    for (const Outstanding &outstanding : std::as_const(m_outstanding))
+        pending = pending || outstanding.command.kind == Command::Capacity;
+    if (capacity == m_lastCapacity && !pending) {
+        emit capacityConfirmed(capacity, 0);
+        return;
+    }
+
+    m_queue.append({Command::Capacity, capacity});
+    pump();
+}
+
+void BarrierWorker::enqueueReset()
+{
+    for (const Command &command : std::as_const(m_queue)) {
+        if (command.kind == Command::Reset)
+            return;
+    }
+    m_queue.append({Command::Reset, 0});
+    pump();
+}
+
+bool BarrierWorker::writeBytes(const QByteArray &bytes)
+{
+    PB_TRACE_SCOPE_DETAIL("serial.write", m_portName);
+    if (m_port->write(bytes) == -1) {
+        dropConnection("Failed to send data to Arduino: " + m_port->errorString());
+        return false;
+    }
+
+    // Completion arrives through bytesWritten; no blocking flush
+    m_bytesLeft += bytes.size();
+    if (!m_writeTimer->isActive())
+        m_writeTimer->start();
+    return true;
+}
+
+void BarrierWorker::sendFrame(Outstanding &pending)
+{
+    if (pending.attempts == 0)
+        pending.firstSent.start();
+    pending.lastSent.start();
+    pending.attempts++;
+    if (writeBytes(encode(pending.frame)) && !m_retransmitTimer->isActive())
+        m_retransmitTimer->start();
+}
+
+void BarrierWorker::pump()
+{
+    if (!m_port || !m_port->isOpen() || m_version < 0)
+        return;
+
+    if (m_version == 0) {
+        // Legacy firmware cannot ack; send one line at a time once the last
+        // one has left the UART so that newer capacities can still coalesce
+        if (m_bytesLeft > 0 || m_queue.isEmpty())
+            return;
+        const Command command = m_queue.takeFirst();
+        Frame frame = command.kind == Command::Capacity ? capacityFrame(0, command.value) : resetFrame(0);
+        if (writeBytes(encodeLegacy(frame)))
+            m_lastCapacity = command.kind == Command::Capacity ? command.value : -1;
+        return;
+    }
+
+    while (m_outstanding.size() < windowSize && !m_queue.isEmpty()) {
+        const Command command = m_queue.takeFirst();
+        const quint8 seq = m_nextSeq++;
+        Outstanding pending{command, command.kind == Command::Capacity ? capacityFrame(seq, command.value)
+                                                                        : resetFrame(seq), 0, {}, {}};
+        m_outstanding.append(pending);
+        sendFrame(m_outstanding.last());
+        if (!m_port->isOpen())
+            return;
+    }
+}
+
+void BarrierWorker::readIncoming()
+{
+    PB_TRACE_SCOPE_DETAIL("serial.read", m_portName);
+    m_decoder.feed(m_port->readAll());
+    const QList<Decoder::Result> results = m_decoder.takeFrames();
+    for (const Decoder::Result &result : results) {
+        // A damaged ack is simply missed; the retransmit timer covers it
+        if (result.corrupt)
+            continue;
+        if (result.frame.type == Ack)
+            handleAck(result.frame);
+        else if (result.frame.type == Nack)
+            handleNack(result.frame.seq);
+        else if (result.frame.type == Telemetry)
+            handleTelemetry(result.frame);
+    }
+    pump();
+}
+
+void BarrierWorker::handleAck(const Frame &ack)
+{
+    const quint8 seq = ack.seq;
+    int index = -1;
+    for (int i = 0; i < m_outstanding.size(); ++i) {
+        if (m_outstanding[i].frame.seq == seq)
+            index = i;
+    }
+    if (index < 0) {
+        // A Hello answered after we gave up on it: the gate booted slowly
+        if (m_version == 0 && m_helloSeq >= 0 && seq == quint8(m_helloSeq))
+            upgradeFromLegacy(ack);
+        return; // otherwise a duplicate ack for a retransmitted frame
+    }
+
+    const Outstanding acked = m_outstanding.takeAt(index);
+    switch (acked.command.kind) {
+    case Command::Hello:
+        identify(ack);
+        break;
+    case Command::Capacity:
+        m_lastCapacity = acked.command.value;
+        emit capacityConfirmed(acked.command.value, int(acked.firstSent.elapsed()));
+
+        // Older capacities still in flight are superseded; the barrier
+        // ignores them, so stop retransmitting
+        for (int i = m_outstanding.size() - 1; i >= 0; --i) {
+            if (m_outstanding[i].command.kind == Command::Capacity && seqNewer(seq, m_outstanding[i].frame.seq))
+                m_outstanding.removeAt(i);
+        }
+        break;
+    case Command::Reset:
+        m_lastCapacity = -1;
+        qDebug() << "Reset stadium barrier";
+        break;
+    }
+
+    if (m_outstanding.isEmpty())
+        m_retransmitTimer->stop();
+}
+
+void BarrierWorker::identify(const Frame &ack)
+{
+    // Only an identified gate earns quick reconnects
+    m_backoffMs = minBackoffMs;
+    const HelloReply reply = parseHelloReply(ack.payload);
+    m_version = qBound(1, int(reply.version), int(CurrentVersion));
+    const QString gateId = reply.gateId.isEmpty() ? m_fallbackId : reply.gateId;
+    qDebug() << "Gate" << gateId << "on" << m_portName << "speaks protocol version" << m_version
+             << "with" << reply.lanes << "lanes";
+    emit identified(gateId, reply.lanes, m_version);
+}
+
+void BarrierWorker::upgradeFromLegacy(const Frame &ack)
+{
+    // The ASCII lines sent meanwhile were ignored by the framed firmware;
+    // send the last capacity again unless a newer one is already queued
+    const int resend = m_lastCapacity;
+    m_lastCapacity = -1;
+    bool queued = false;
+    for (const Command &command : std::as_const(m_queue))
+        queued = queued || command.kind == Command::Capacity;
+    if (resend >= 0 && !queued)
+        m_queue.prepend({Command::Capacity, resend});
+
+    identify(ack);
+    pump();
+}
+
+void BarrierWorker::handleTelemetry(const Frame &frame)
+{
+    int entries, exits;
+    if (!parseTelemetry(frame.payload, &entries, &exits))
+        return;
+
+    // Telemetry is not acknowledged; a sequence gap is reported as lost frames
+    quint16 lost = 0;
+    if (m_haveTelemetrySeq)
+        lost = quint8(frame.seq - m_telemetrySeq - 1);
+    m_haveTelemetrySeq = true;
+    m_telemetrySeq = frame.seq;
+
+    m_telemetry->push({telemetryClockMs(), quint16(entries), quint16(exits), lost});
+}
+
+void BarrierWorker::handleNack(quint8 seq)
+{
+    // The barrier saw the frame damaged; resend right away instead of waiting
+    for (Outstanding &pending : m_outstanding) {
+        if (pending.frame.seq == seq) {
+            if (pending.attempts >= maxAttempts)
+                dropConnection("Stadium barrier keeps rejecting frames");
+            else
+                sendFrame(pending);
+            return;
+        }
+    }
+}
+
+void BarrierWorker::checkRetransmits()
+{
+    for (int i = 0; i < m_outstanding.size(); ++i) {
+        Outstanding &pending = m_outstanding[i];
+        const bool hello = pending.command.kind == Command::Hello;
+        if (pending.lastSent.elapsed() < (hello ? helloTimeoutMs : ackTimeoutMs))
+            continue;
+
+        if (hello && pending.attempts >= helloAttempts) {
+            m_outstanding.removeAt(i);
+            fallBackToLegacy();
+            return;
+        }
+        if (pending.attempts >= maxAttempts) {
+            dropConnection(QString("No acknowledgement from stadium barrier after %1 attempts").arg(maxAttempts));
+            return;
+        }
+        sendFrame(pending);
+        if (!m_port->isOpen())
+            return;
+    }
+}
+
+void BarrierWorker::fallBackToLegacy()
+{
+    if (!m_allowLegacy) {
+        // Probably not a gate at all: never send it commands, and release
+        // the port so the device (reset again by every open) is left alone
+        qDebug() << "Device on" << m_portName << "did not answer Hello; not a gate controller";
+        m_retransmitTimer->stop();
+        m_port->close();
+        emit connectionChanged(false, m_portName);
+        scheduleReconnect();
+        return;
+    }
+
+    qDebug() << "Gate on" << m_portName << "did not answer Hello; using the ASCII protocol";
+    m_backoffMs = minBackoffMs;
+    m_version = 0;
+    emit identified(m_fallbackId, 1, m_version);
+    if (m_outstanding.isEmpty())
+        m_retransmitTimer->stop();
+    pump();
+}
+
+void BarrierWorker::bytesWritten(qint64 bytes)
+{
+    m_bytesLeft = qMax<qint64>(0, m_bytesLeft - bytes);
+    if (m_bytesLeft > 0)
+        return;
+
+    m_writeTimer->stop();
+    if (m_version == 0)
+        pump();
+}
+
+void BarrierWorker::writeTimedOut()
+{
+    dropConnection(QString("Write to Arduino timed out after %1 ms").arg(writeTimeoutMs));
+}
+
+void BarrierWorker::portError(QSerialPort::SerialPortError error)
+{
+    // Unplugged or otherwise unusable; anything else is reported by the write path
+    if (error == QSerialPort::ResourceError || error == QSerialPort::PermissionError)
+        dropConnection(m_port->errorString());
+}
+
+// BarrierLink implementation
+BarrierLink::BarrierLink(const QString &portName, const QString &fallbackId, bool allowLegacy, QObject *parent)
+    : QObject(parent), m_portName(portName), m_gateId(fallbackId), m_lanes(0),
+      m_telemetry(std::make_shared<TelemetryRing>()),
+      m_worker(new BarrierWorker(portName, fallbackId, allowLegacy, m_telemetry)), m_connected(false)
+{
+    m_thread.setObjectName("Gate " + portName);
+    m_worker->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::started, m_worker, &BarrierWorker::start);
+    connect(&m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+
+    connect(m_worker, &BarrierWorker::connectionChanged, this, [this](bool connected, const QString &portName) {
+        m_connected = connected;
+        emit connectionChanged(connected, portName);
+    });
+    connect(m_worker, &BarrierWorker::identified, this, [this](const QString &gateId, int lanes, int version) {
+        m_gateId = gateId;
+        m_lanes = lanes;
+        emit identified(gateId, lanes, version);
+    });
+    connect(m_worker, &BarrierWorker::capacityConfirmed, this, &BarrierLink::capacityConfirmed);
+    connect(m_worker, &BarrierWorker::errorOccurred, this, &BarrierLink::errorOccurred);
+}
+
+BarrierLink::~BarrierLink()
+{
+    m_thread.quit();
+    m_thread.wait();
+}
+
+void BarrierLink::start()
+{
+    if (!m_thread.isRunning())
+        m_thread.start();
+}
+
+void BarrierLink::setCapacity(int capacity)
+{
+    QMetaObject::invokeMethod(m_worker, "enqueueCapacity", Qt::QueuedConnection, Q_ARG(int, capacity));
+}
+
+void BarrierLink::reset()
+{
+    QMetaObject::invokeMethod(m_worker, "enqueueReset", Qt::QueuedConnection);
+}
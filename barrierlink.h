@@ -0,0 +1,149 @@
+#ifndef BARRIERLINK_H
+#define BARRIERLINK_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QSerialPort>
+#include <QString>
+#include <QThread>
+#include <QTimer>
+#include <atomic>
+#include <memory>
+#include "barrierprotocol.h"
+#include "telemetry.h"
+
+// Lives on the barrier thread and owns the serial port. Commands wait in a
+// small queue: a new capacity replaces any capacity not yet sent (last
+// write wins), a reset is queued once. On connect the worker waits for the
+// board to boot, then says Hello; a barrier that answers speaks the framed
+// protocol, where up to windowSize frames may be unacknowledged and each is
+// retransmitted until acked. A silent device is only taken for a legacy
+// barrier, driven with the ASCII commands until a late Hello ack upgrades
+// it, when allowLegacy is set (a port configured by hand); otherwise the
+// port is closed again and probed with backoff.
+// A lost port is reopened with exponential backoff. Each worker drives one
+// gate controller on the port chosen by the GateManager and pushes the
+// gate's turnstile counts into its telemetry ring without signalling.
+class BarrierWorker : public QObject
+{
+    Q_OBJECT
+public:
+    BarrierWorker(const QString &portName, const QString &fallbackId, bool allowLegacy,
+                  std::shared_ptr<TelemetryRing> telemetry);
+    ~BarrierWorker();
+
+public slots:
+    void start();
+    void enqueueCapacity(int capacity);
+    void enqueueReset();
+
+signals:
+    void connectionChanged(bool connected, const QString &portName);
+    void identified(const QString &gateId, int lanes, int version);
+    void capacityConfirmed(int capacity, int roundTripMs);
+    void errorOccurred(const QString &message);
+
+private slots:
+    void pump();
+    void readIncoming();
+    void bytesWritten(qint64 bytes);
+    void writeTimedOut();
+    void checkRetransmits();
+    void portError(QSerialPort::SerialPortError error);
+    void reconnect();
+    void sendHello();
+
+private:
+    struct Command
+    {
+        enum Kind { Hello, Capacity, Reset } kind;
+        int value;
+    };
+
+    struct Outstanding
+    {
+        Command command;
+        BarrierProtocol::Frame frame;
+        int attempts;
+        QElapsedTimer firstSent;
+        QElapsedTimer lastSent;
+    };
+
+    bool openPort();
+    void dropConnection(const QString &reason);
+    void scheduleReconnect();
+    void requeue(const Command &command);
+    bool writeBytes(const QByteArray &bytes);
+    void sendFrame(Outstanding &pending);
+    void handleAck(const BarrierProtocol::Frame &ack);
+    void handleNack(quint8 seq);
+    void fallBackToLegacy();
+    void identify(const BarrierProtocol::Frame &ack);
+    void upgradeFromLegacy(const BarrierProtocol::Frame &ack);
+    void handleTelemetry(const BarrierProtocol::Frame &frame);
+
+    QString m_portName;
+    QString m_fallbackId; // used when the controller does not report its own id
+    bool m_allowLegacy;
+    QSerialPort *m_port;
+    QTimer *m_writeTimer;
+    QTimer *m_retransmitTimer;
+    QTimer *m_reconnectTimer;
+    QTimer *m_settleTimer;
+    int m_backoffMs;
+    QList<Command> m_queue;
+    QList<Outstanding> m_outstanding;
+    BarrierProtocol::Decoder m_decoder;
+    int m_version;   // -1 while negotiating, else the protocol version in use
+    quint8 m_nextSeq;
+    int m_helloSeq; // seq of the last Hello, -1 before it is sent; a late ack still counts
+    qint64 m_bytesLeft;
+    int m_lastCapacity; // last capacity the barrier accepted, -1 unknown
+    std::shared_ptr<TelemetryRing> m_telemetry;
+    bool m_haveTelemetrySeq;
+    quint8 m_telemetrySeq;
+};
+
+// GUI-side handle of one gate controller. Every call returns immediately;
+// the serial traffic happens on a thread owned by this link, so gates never
+// wait on each other.
+class BarrierLink : public QObject
+{
+    Q_OBJECT
+public:
+    // allowLegacy: the port is known to be a gate, so a silent controller is
+    // driven with the ASCII protocol instead of being ignored
+    BarrierLink(const QString &portName, const QString &fallbackId, bool allowLegacy, QObject *parent = nullptr);
+    ~BarrierLink();
+
+    void start();
+    void setCapacity(int capacity);
+    void reset();
+    bool isConnected() const { return m_connected; }
+    bool isIdentified() const { return m_lanes > 0; }
+    QString portName() const { return m_portName; }
+    QString gateId() const { return m_gateId; }
+    int lanes() const { return m_lanes; }
+
+    // Filled by the gate thread, drained by the OccupancyTracker
+    TelemetryRing *telemetry() const { return m_telemetry.get(); }
+
+signals:
+    void connectionChanged(bool connected, const QString &portName);
+    void identified(const QString &gateId, int lanes, int version);
+    void capacityConfirmed(int capacity, int roundTripMs);
+    void errorOccurred(const QString &message);
+
+private:
+    QString m_portName;
+    QString m_gateId;
+    int m_lanes; // 0 until the handshake completes
+    std::shared_ptr<TelemetryRing> m_telemetry;
+    QThread m_thread;
+    BarrierWorker *m_worker;
+    std::atomic<bool> m_connected;
+};
+
+#endif // BARRIERLINK_H
@@ -0,0 +1,171 @@
+#include "barrierprotocol.h"
+#include <QtEndian>
+
+namespace BarrierProtocol {
+
+quint16 crc16(const char *data, int size)
+{
+    // CRC-16/CCITT-FALSE: poly 0x1021, init 0xFFFF; cheap enough for an AVR
+    quint16 crc = 0xFFFF;
+    for (int i = 0; i < size; ++i) {
+        crc ^= quint16(quint8(data[i])) << 8;
+        for (int bit = 0; bit < 8; ++bit)
+            crc = (crc & 0x8000) ? quint16((crc << 1) ^ 0x1021) : quint16(crc << 1);
+    }
+    return crc;
+}
+
+QByteArray encode(const Frame &frame)
+{
+    Q_ASSERT(frame.payload.size() <= MaxPayload);
+
+    QByteArray bytes;
+    bytes.reserve(HeaderSize + frame.payload.size() + TrailerSize);
+    bytes.append(char(StartOfFrame));
+    bytes.append(char(frame.version));
+    bytes.append(char(frame.seq));
+    bytes.append(char(frame.type));
+    bytes.append(char(frame.payload.size()));
+    bytes.append(frame.payload);
+
+    const quint16 crc = crc16(bytes.constData() + 1, int(bytes.size()) - 1);
+    bytes.append(char(crc >> 8));
+    bytes.append(char(crc & 0xFF));
+    return bytes;
+}
+
+Frame capacityFrame(quint8 seq, int capacity)
+{
+    Frame frame;
+    frame.seq = seq;
+    frame.type = SetCapacity;
+    frame.payload.resize(4);
+    qToBigEndian<quint32>(quint32(qMax(0, capacity)), frame.payload.data());
+    return frame;
+}
+
+Frame resetFrame(quint8 seq)
+{
+    Frame frame;
+    frame.seq = seq;
+    frame.type = Reset;
+    return frame;
+}
+
+Frame helloFrame(quint8 seq)
+{
+    Frame frame;
+    frame.seq = seq;
+    frame.type = Hello;
+    frame.payload.append(char(CurrentVersion));
+    return frame;
+}
+
+int capacityFromPayload(const QByteArray &payload)
+{
+    if (payload.size() != 4)
+        return -1;
+    return int(qFromBigEndian<quint32>(payload.constData()));
+}
+
+HelloReply parseHelloReply(const QByteArray &payload)
+{
+    // Older version 1 firmware acks Hello with an empty payload
+    HelloReply reply;
+    if (payload.size() >= 1)
+        reply.version = quint8(payload[0]);
+    if (payload.size() >= 2)
+        reply.lanes = qMax(1, int(quint8(payload[1])));
+    if (payload.size() > 2)
+        reply.gateId = QString::fromUtf8(payload.mid(2)).trimmed();
+    return reply;
+}
+
+Frame telemetryFrame(quint8 seq, int entries, int exits)
+{
+    Frame frame;
+    frame.seq = seq;
+    frame.type = Telemetry;
+    frame.payload.resize(4);
+    qToBigEndian<quint16>(quint16(qBound(0, entries, 0xFFFF)), frame.payload.data());
+    qToBigEndian<quint16>(quint16(qBound(0, exits, 0xFFFF)), frame.payload.data() + 2);
+    return frame;
+}
+
+bool parseTelemetry(const QByteArray &payload, int *entries, int *exits)
+{
+    if (payload.size() != 4)
+        return false;
+    *entries = qFromBigEndian<quint16>(payload.constData());
+    *exits = qFromBigEndian<quint16>(payload.constData() + 2);
+    return true;
+}
+
+QByteArray encodeLegacy(const Frame &frame)
+{
+    // Format: C{capacity}\n or R\n
+    switch (frame.type) {
+    case SetCapacity:
+        return QString("C%1\n").arg(capacityFromPayload(frame.payload)).toUtf8();
+    case Reset:
+        return QByteArray("R\n");
+    default:
+        return QByteArray();
+    }
+}
+
+void Decoder::feed(const QByteArray &bytes)
+{
+    m_buffer.append(bytes);
+}
+
+QList<Decoder::Result> Decoder::takeFrames()
+{
+    QList<Result> results;
+    int pos = 0;
+    while (pos < m_buffer.size()) {
+        // Resynchronise on the next start byte
+        if (quint8(m_buffer[pos]) != StartOfFrame) {
+            ++pos;
+            ++m_discarded;
+            continue;
+        }
+        if (m_buffer.size() - pos < HeaderSize)
+            break;
+
+        const int length = quint8(m_buffer[pos + 4]);
+        if (length > MaxPayload) {
+            // Not a real header; the start byte was payload noise
+            ++pos;
+            ++m_discarded;
+            continue;
+        }
+        const int frameSize = HeaderSize + length + TrailerSize;
+        if (m_buffer.size() - pos < frameSize)
+            break;
+
+        const char *data = m_buffer.constData() + pos;
+        const quint16 expected = quint16(quint8(data[frameSize - 2]) << 8 | quint8(data[frameSize - 1]));
+
+        Result result;
+        result.frame.version = quint8(data[1]);
+        result.frame.seq = quint8(data[2]);
+        result.frame.type = quint8(data[3]);
+        result.corrupt = crc16(data + 1, frameSize - 3) != expected;
+        if (!result.corrupt)
+            result.frame.payload = QByteArray(data + HeaderSize, length);
+        results.append(result);
+
+        // A corrupt frame may have a damaged length; only skip its start byte
+        if (result.corrupt) {
+            ++pos;
+            ++m_discarded;
+        } else {
+            pos += frameSize;
+        }
+    }
+    m_buffer.remove(0, pos);
+    return results;
+}
+
+} // namespace BarrierProtocol
@@ -0,0 +1,109 @@
+#ifndef BARRIERPROTOCOL_H
+#define BARRIERPROTOCOL_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QtGlobal>
+
+// Wire format spoken with the stadium barrier.
+//
+// Version 1 frames:
+//   0xA5 | version | seq | type | length | payload (0..32) | CRC-16 (big endian)
+// The CRC (CCITT-FALSE) covers version through payload. Every command is
+// answered with an Ack or Nack carrying the command's sequence number.
+// Capacities travel as a big-endian quint32; the barrier applies a capacity
+// only if its sequence number is newer than the last one applied, so a
+// retransmitted stale frame cannot undo a newer value.
+//
+// Gates stream turnstile counts in unacknowledged Telemetry frames:
+//   entries since the previous frame | exits since the previous frame
+// both big-endian quint16; a gap in their sequence numbers means lost frames.
+//
+// The Ack to Hello identifies the gate controller:
+//   version | lanes | gate id (UTF-8, rest of the payload)
+//
+// Version 0 is the original ASCII protocol ("C<n>\n", "R\n") with no
+// acknowledgement; it is used when the barrier does not answer Hello.
+namespace BarrierProtocol {
+
+const quint8 StartOfFrame = 0xA5;
+const quint8 CurrentVersion = 1;
+const int MaxPayload = 32;
+const int HeaderSize = 5; // start, version, seq, type, length
+const int TrailerSize = 2;
+
+enum FrameType : quint8 {
+    Hello = 0x01,
+    SetCapacity = 0x02,
+    Reset = 0x03,
+    Telemetry = 0x10,
+    Ack = 0x80,
+    Nack = 0x81
+};
+
+enum NackReason : quint8 {
+    BadChecksum = 0x01,
+    UnknownType = 0x02,
+    BadPayload = 0x03
+};
+
+struct Frame
+{
+    quint8 version = CurrentVersion;
+    quint8 seq = 0;
+    quint8 type = Hello;
+    QByteArray payload;
+};
+
+quint16 crc16(const char *data, int size);
+
+QByteArray encode(const Frame &frame);
+Frame capacityFrame(quint8 seq, int capacity);
+Frame resetFrame(quint8 seq);
+Frame helloFrame(quint8 seq);
+int capacityFromPayload(const QByteArray &payload);
+
+struct HelloReply
+{
+    quint8 version = CurrentVersion;
+    int lanes = 1;
+    QString gateId; // empty if the controller did not send one
+};
+
+HelloReply parseHelloReply(const QByteArray &payload);
+
+Frame telemetryFrame(quint8 seq, int entries, int exits);
+bool parseTelemetry(const QByteArray &payload, int *entries, int *exits);
+
+// Version 0 encoding of the same commands
+QByteArray encodeLegacy(const Frame &frame);
+
+// Sequence numbers wrap; a is newer than b if it is ahead by less than half the range
+inline bool seqNewer(quint8 a, quint8 b) { return a != b && quint8(a - b) < 128; }
+
+// Incremental decoder for bytes arriving from the port. Garbage before a
+// start byte is skipped; a frame with a bad CRC is reported as corrupt so
+// the sender can be asked to retransmit it.
+class Decoder
+{
+public:
+    struct Result
+    {
+        Frame frame;
+        bool corrupt = false;
+    };
+
+    void feed(const QByteArray &bytes);
+    QList<Result> takeFrames();
+    void clear() { m_buffer.clear(); }
+    int discardedBytes() const { return m_discarded; }
+
+private:
+    QByteArray m_buffer;
+    int m_discarded = 0;
+};
+
+} // namespace BarrierProtocol
+
+#endif // BARRIERPROTOCOL_H
@@ -0,0 +1,1021 @@
+#include "commandline.h"
+#include "attendancecube.h"
+#include "attendancestats.h"
+#include "barrierlink.h"
+#include "connection.h"
+#include "matchfilter.h"
+#include "matchgenerator.h"
+#include "matchsimulation.h"
+#include "matchsort.h"
+#include "queryprofiler.h"
+#include "reportcache.h"
+#include "reportwriter.h"
+#include "trace.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QGuiApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <numeric>
+
+#ifdef Q_OS_UNIX
+#include "virtualgate.h"
+#include <QDir>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const QStringList commands = {"export", "stats", "simulate", "import", "generate", "bench", "gate-sim", "gate-bench"};
+
+// Splits RFC 4180 CSV text into records; quoted fields may hold commas,
+// quotes ("") and line breaks
+QList<QStringList> parseCsv(const QString &text)
+{
+    QList<QStringList> records;
+    QStringList record;
+    QString field;
+    bool quoted = false;
+
+    for (int i = 0; i < text.size(); ++i) {
+        const QChar c = text[i];
+        if (quoted) {
+            if (c == '"' && i + 1 < text.size() && text[i + 1] == '"') {
+                field += '"';
+                ++i;
+            } else if (c == '"') {
+                quoted = false;
+            } else {
+                field += c;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            record << field;
+            field.clear();
+        } else if (c == '\n' || c == '\r') {
+            if (c == '\r' && i + 1 < text.size() && text[i + 1] == '\n')
+                ++i;
+            record << field;
+            field.clear();
+            if (!(record.size() == 1 && record[0].isEmpty()))
+                records << record;
+            record.clear();
+        } else {
+            field += c;
+        }
+    }
+    if (!field.isEmpty() || !record.isEmpty()) {
+        record << field;
+        records << record;
+    }
+    return records;
+}
+
+QDateTime parseDate(const QString &text)
+{
+    const QString trimmed = text.trimmed();
+    for (const char *format : {"yyyy-MM-dd HH:mm", "yyyy-MM-dd HH:mm:ss", "yyyy-MM-ddTHH:mm:ss", "yyyy-MM-dd"}) {
+        QDateTime dateTime = QDateTime::fromString(trimmed, format);
+        if (dateTime.isValid())
+            return dateTime;
+    }
+    return QDateTime();
+}
+
+QJsonObject percentiles(QList<double> samples)
+{
+    QJsonObject result;
+    if (samples.isEmpty())
+        return result;
+    std::sort(samples.begin(), samples.end());
+    auto at = [&samples](double fraction) {
+        return samples[qMin(int(samples.size()) - 1, int(fraction * samples.size()))];
+    };
+    result["p50"] = at(0.50);
+    result["p95"] = at(0.95);
+    result["p99"] = at(0.99);
+    result["max"] = samples.last();
+    result["samples"] = int(samples.size());
+    return result;
+}
+
+} // namespace
+
+bool CommandLine::isCommand(int argc, char *argv[])
+{
+    return argc > 1 && commands.contains(QString::fromLocal8Bit(argv[1]));
+}
+
+int CommandLine::run(int argc, char *argv[])
+{
+    // PDF export needs fonts, hence a QGuiApplication, but never a display
+    bool needsGui = qstrcmp(argv[1], "bench") == 0;
+    for (int i = 1; i < argc; ++i) {
+        QString argument = QString::fromLocal8Bit(argv[i]);
+        // Same case-insensitive match as exportMatches()
+        if (argument.compare("--format=pdf", Qt::CaseInsensitive) == 0
+            || (argument == "--format" && i + 1 < argc && qstricmp(argv[i + 1], "pdf") == 0))
+            needsGui = true;
+    }
+
+    QScopedPointer<QCoreApplication> app;
+    if (needsGui) {
+        if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+        app.reset(new QGuiApplication(argc, argv));
+    } else {
+        app.reset(new QCoreApplication(argc, argv));
+    }
+
+    CommandLine commandLine(QCoreApplication::arguments());
+    int result = commandLine.exec();
+#ifdef PROBALL_TRACING
+    Trace::writeFromEnvironment();
+#endif
+    return result;
+}
+
+CommandLine::CommandLine(const QStringList &arguments)
+{
+    m_parser.addPositionalArgument("command", "export, stats, simulate, import, generate, bench, gate-sim or gate-bench");
+    m_parser.addOptions({
+        {"format", "Export format: csv or pdf.", "format", "csv"},
+        {"output", "Output file; CSV goes to stdout when omitted.", "file"},
+        {"venue", "Only matches at this venue (repeatable).", "venue"},
+        {"type", "Only matches of this type (repeatable).", "type"},
+        {"status", "Only matches with this status (repeatable).", "status"},
+        {"from", "Only matches on or after this date (yyyy-MM-dd).", "date"},
+        {"to", "Only matches on or before this date (yyyy-MM-dd).", "date"},
+        {"by", "Stats grouping: type, venue, month, day, weekday or status.", "dimension", "type"},
+        {"match", "Simulate only this match ID.", "id"},
+        {"seed", "Random seed for reproducible simulations.", "seed"},
+        {"dry-run", "Validate the import file without inserting."},
+        {"sizes", "Comma-separated match counts bench runs at.", "counts", "10000,100000,1000000"},
+        {"repeat", "Times bench runs each phase per size.", "count", "3"},
+        {"skip", "Bench phase to leave out (repeatable).", "phase"},
+        {"link", "Stable path linked to the virtual gate's pseudo-terminal.", "path"},
+        {"gate-id", "Id the virtual gate reports in its handshake.", "id", "VGATE-1"},
+        {"lanes", "Lanes the virtual gate reports in its handshake.", "count", "1"},
+        {"latency", "Virtual gate reply delay in milliseconds.", "ms", "0"},
+        {"jitter", "Extra random reply delay in milliseconds.", "ms", "0"},
+        {"corrupt", "Chance that a frame is corrupted, each direction.", "probability", "0"},
+        {"drop", "Chance that a reply is lost.", "probability", "0"},
+        {"disconnect-after", "Unplug the virtual gate after this many frames.", "frames", "0"},
+        {"legacy", "Virtual gate speaks only the ASCII protocol."},
+        {"record", "Record the virtual gate's traffic to this file.", "file"},
+        {"events-per-second", "Turnstile entries per second the virtual gate streams.", "count", "0"},
+        {"replay", "Replay the commands of a recording instead of generating updates.", "file"},
+        {"duration", "Seconds gate-sim runs before exiting; 0 runs until killed.", "seconds", "0"},
+        {"updates", "Capacity updates gate-bench sends.", "count", "1000"},
+        {"interval", "Milliseconds between gate-bench updates; 0 sends them back to back.", "ms", "1"},
+        {"timeout", "Seconds gate-bench waits for the gate to settle.", "seconds", "30"},
+    });
+
+    // Parsing errors are reported by exec()
+    m_parser.parse(arguments);
+    m_arguments = m_parser.positionalArguments();
+    if (!m_arguments.isEmpty())
+        m_command = m_arguments.takeFirst();
+}
+
+int CommandLine::exec()
+{
+    if (!m_parser.unknownOptionNames().isEmpty())
+        return fail("Unknown option: " + m_parser.unknownOptionNames().join(", "), 2);
+
+    if (m_command == "export")
+        return exportMatches();
+    if (m_command == "stats")
+        return stats();
+    if (m_command == "simulate")
+        return simulate();
+    if (m_command == "import")
+        return importMatches();
+    if (m_command == "generate")
+        return generate();
+    if (m_command == "bench")
+        return bench();
+    if (m_command == "gate-sim")
+        return gateSim();
+    if (m_command == "gate-bench")
+        return gateBench();
+    return fail("Unknown command: " + m_command, 2);
+}
+
+int CommandLine::fail(const QString &message, int code) const
+{
+    QJsonObject error;
+    error["command"] = m_command;
+    error["error"] = message;
+    QTextStream(stderr) << QJsonDocument(error).toJson(QJsonDocument::Compact) << Qt::endl;
+    return code;
+}
+
+void CommandLine::print(const QJsonObject &object) const
+{
+    QTextStream(stdout) << QJsonDocument(object).toJson(QJsonDocument::Indented);
+}
+
+bool CommandLine::connect()
+{
+    Connection connection;
+    return connection.createconnect();
+}
+
+bool CommandLine::loadMatches(QVector<Match> &matches)
+{
+    QString error;
+    if (!MatchStore::loadAll(QSqlDatabase::database(), matches, &error)) {
+        fail("Failed to load matches: " + error);
+        return false;
+    }
+    return true;
+}
+
+int CommandLine::exportMatches()
+{
+    const QString format = m_parser.value("format").toLower();
+    const QString output = m_parser.value("output");
+    if (format != "csv" && format != "pdf")
+        return fail("Unknown export format: " + format, 2);
+    if (format == "pdf" && output.isEmpty())
+        return fail("PDF export needs --output", 2);
+
+    // A mistyped bound must not silently widen the export to the whole table
+    const QDate from = QDate::fromString(m_parser.value("from"), "yyyy-MM-dd");
+    const QDate to = QDate::fromString(m_parser.value("to"), "yyyy-MM-dd");
+    if (m_parser.isSet("from") && !from.isValid())
+        return fail("Invalid --from date: " + m_parser.value("from") + " (expected yyyy-MM-dd)", 2);
+    if (m_parser.isSet("to") && !to.isValid())
+        return fail("Invalid --to date: " + m_parser.value("to") + " (expected yyyy-MM-dd)", 2);
+
+    QElapsedTimer timer;
+    timer.start();
+    if (!connect())
+        return fail("Database connection failed");
+
+    QVector<Match> matches;
+    if (!loadMatches(matches))
+        return 1;
+
+    // Same filter engine as the filter panel
+    MatchFilterCriteria criteria;
+    criteria.from = from;
+    criteria.to = to;
+    const QStringList venues = m_parser.values("venue");
+    const QStringList types = m_parser.values("type");
+    const QStringList statuses = m_parser.values("status");
+    criteria.venues = QSet<QString>(venues.begin(), venues.end());
+    criteria.types = QSet<QString>(types.begin(), types.end());
+    criteria.statuses = QSet<QString>(statuses.begin(), statuses.end());
+
+    MatchFilterEngine engine;
+    engine.setMatches(matches, 1);
+    QVector<int> rows = engine.evaluate(criteria);
+    std::sort(rows.begin(), rows.end(), [&matches](int a, int b) {
+        if (matches[a].date != matches[b].date)
+            return matches[a].date < matches[b].date;
+        return matches[a].id < matches[b].id;
+    });
+
+    MatchRowSource source(matches, rows, MatchRowSource::defaultHeaders());
+    QJsonObject result;
+    result["command"] = "export";
+    result["format"] = format;
+    result["output"] = output;
+
+    if (format == "csv") {
+        QFile file(output);
+        bool opened = output.isEmpty() ? file.open(stdout, QIODevice::WriteOnly)
+                                       : file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+        if (!opened)
+            return fail("Cannot open output: " + file.errorString());
+
+        CsvReportWriter writer;
+        if (!writer.write(&file, source))
+            return fail(writer.errorString());
+        result["rows"] = writer.rowCount();
+    } else {
+        TableReportWriter writer("Matches Report");
+        writer.setPageCache(&ReportCache::instance());
+        if (!writer.writePdf(output, source))
+            return fail(writer.errorString());
+        result["rows"] = int(rows.size());
+        result["pages"] = writer.pageCount();
+        result["cachedPages"] = writer.cachedPages();
+    }
+
+    // CSV on stdout is the output itself; only report on files
+    if (!output.isEmpty()) {
+        result["elapsedMs"] = timer.elapsed();
+        print(result);
+    }
+    return 0;
+}
+
+int CommandLine::stats()
+{
+    const QHash<QString, AttendanceCube::Dimension> dimensions = {
+        {"type", AttendanceCube::Type}, {"venue", AttendanceCube::Venue}, {"month", AttendanceCube::Month},
+        {"weekday", AttendanceCube::Weekday}, {"status", AttendanceCube::Status}, {"day", AttendanceCube::Day}
+    };
+    const QString by = m_parser.value("by").toLower();
+    if (!dimensions.contains(by))
+        return fail("Unknown grouping: " + by, 2);
+
+    if (!connect())
+        return fail("Database connection failed");
+
+    QVector<Match> matches;
+    if (!loadMatches(matches))
+        return 1;
+
+    const QHash<QString, CubeCell> cells = AttendanceCube::rollup(matches, dimensions.value(by));
+    QStringList keys = cells.keys();
+    keys.sort();
+
+    QJsonArray groups;
+    for (const QString &key : keys) {
+        const CubeCell &cell = cells[key];
+        QJsonObject group;
+        group["key"] = key;
+        group["matches"] = cell.matches;
+        group["withAttendance"] = cell.attendanceCount;
+        group["total"] = cell.attendanceSum;
+        group["average"] = cell.average();
+        group["median"] = cell.median();
+        group["p90"] = cell.p90();
+        group["min"] = cell.minimum;
+        group["max"] = cell.maximum;
+        group["trendPerMonth"] = cell.trendPerMonth();
+        groups.append(group);
+    }
+
+    QJsonObject result;
+    result["command"] = "stats";
+    result["by"] = by;
+    result["matches"] = int(matches.size());
+    result["groups"] = groups;
+    print(result);
+    return 0;
+}
+
+int CommandLine::simulate()
+{
+    bool ok = false;
+    const int runs = m_arguments.value(0).toInt(&ok);
+    if (!ok || runs <= 0)
+        return fail("simulate needs a positive number of runs", 2);
+
+    if (!connect())
+        return fail("Database connection failed");
+
+    QVector<Match> matches;
+    if (!loadMatches(matches))
+        return 1;
+
+    int onlyMatch = -1;
+    if (m_parser.isSet("match")) {
+        onlyMatch = m_parser.value("match").toInt(&ok);
+        if (!ok)
+            return fail("Invalid match ID", 2);
+    }
+
+    QRandomGenerator generator = m_parser.isSet("seed")
+                                     ? QRandomGenerator(m_parser.value("seed").toUInt())
+                                     : QRandomGenerator::securelySeeded();
+
+    // Each run plans the goal timeline exactly like the animated simulation
+    QJsonArray results;
+    for (const Match &match : std::as_const(matches)) {
+        if (onlyMatch >= 0 && match.id != onlyMatch)
+            continue;
+
+        int home = 0;
+        int away = 0;
+        if (!MatchSimulation::parseScore(match.score, &home, &away))
+            continue;
+
+        QVector<int> minuteHistogram(90, 0);
+        qint64 firstHalfGoals = 0;
+        qint64 firstGoalMinuteSum = 0;
+        for (int run = 0; run < runs; ++run) {
+            QList<int> goals = MatchSimulation::planGoalTimes(home, &generator)
+                             + MatchSimulation::planGoalTimes(away, &generator);
+            std::sort(goals.begin(), goals.end());
+            for (int minute : std::as_const(goals)) {
+                minuteHistogram[qBound(0, minute, 89)]++;
+                if (minute < 45)
+                    firstHalfGoals++;
+            }
+            if (!goals.isEmpty())
+                firstGoalMinuteSum += goals.first();
+        }
+
+        QJsonArray histogram;
+        for (int count : std::as_const(minuteHistogram))
+            histogram.append(count);
+
+        QJsonObject entry;
+        entry["id"] = match.id;
+        entry["score"] = match.score;
+        entry["home"] = home;
+        entry["away"] = away;
+        entry["firstHalfGoalsAverage"] = double(firstHalfGoals) / runs;
+        entry["firstGoalMinuteAverage"] = home + away > 0 ? double(firstGoalMinuteSum) / runs : QJsonValue();
+        entry["goalMinuteHistogram"] = histogram;
+        results.append(entry);
+    }
+
+    if (onlyMatch >= 0 && results.isEmpty())
+        return fail(QString("Match %1 not found or has no valid score").arg(onlyMatch));
+
+    QJsonObject result;
+    result["command"] = "simulate";
+    result["runs"] = runs;
+    result["matches"] = results;
+    print(result);
+    return 0;
+}
+
+int CommandLine::importMatches()
+{
+    const QString fileName = m_arguments.value(0);
+    if (fileName.isEmpty())
+        return fail("import needs a CSV file", 2);
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return fail("Cannot open " + fileName + ": " + file.errorString());
+    const QList<QStringList> records = parseCsv(QString::fromUtf8(file.readAll()));
+    if (records.isEmpty())
+        return fail("The file is empty");
+
+    // Accept both the database column names and the table labels as headers
+    const QList<QStringList> aliases = {
+        {"DATEMATCH", "DATE"}, {"LIEU"}, {"STATUS"}, {"SCORE"}, {"TYPEMATCH", "TYPE"}, {"SPECTATEURS"}
+    };
+    QVector<int> columnOf(aliases.size(), -1);
+    const QStringList header = records.first();
+    for (int col = 0; col < header.size(); ++col) {
+        const QString name = header[col].trimmed().toUpper();
+        for (int field = 0; field < aliases.size(); ++field) {
+            if (aliases[field].contains(name))
+                columnOf[field] = col;
+        }
+    }
+    if (columnOf[0] < 0 || columnOf[1] < 0 || columnOf[2] < 0)
+        return fail("The header must name at least DATEMATCH, LIEU and STATUS", 2);
+
+    // Validate everything before touching the database
+    struct Row { QDateTime date; QStringList values; };
+    QVector<Row> rows;
+    rows.reserve(records.size() - 1);
+    for (int line = 1; line < records.size(); ++line) {
+        const QStringList &record = records[line];
+        Row row;
+        for (int field = 0; field < aliases.size(); ++field)
+            row.values << (columnOf[field] >= 0 ? record.value(columnOf[field]).trimmed() : QString());
+
+        row.date = parseDate(row.values[0]);
+        if (!row.date.isValid())
+            return fail(QString("Record %1: invalid date '%2'").arg(line + 1).arg(row.values[0]));
+        if (row.values[1].isEmpty() || row.values[2].isEmpty())
+            return fail(QString("Record %1: Lieu and Status must be filled").arg(line + 1));
+        rows.append(row);
+    }
+
+    QJsonObject result;
+    result["command"] = "import";
+    result["file"] = fileName;
+    result["records"] = int(rows.size());
+    if (m_parser.isSet("dry-run")) {
+        result["inserted"] = 0;
+        result["dryRun"] = true;
+        print(result);
+        return 0;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    if (!connect())
+        return fail("Database connection failed");
+
+    // One prepared statement, one transaction: all rows or none
+    QSqlDatabase db = QSqlDatabase::database();
+    if (!db.transaction())
+        return fail("Cannot start a transaction: " + db.lastError().text());
+
+    ProfiledQuery query("MATCHES import", db);
+    query.prepare(QString::fromLatin1(MatchStore::insertColumns()));
+    for (int i = 0; i < rows.size(); ++i) {
+        const Row &row = rows[i];
+        query.bindValue(0, row.date);
+        for (int field = 1; field < aliases.size(); ++field)
+            query.bindValue(field, row.values[field]);
+
+        if (!query.exec()) {
+            QString error = query.lastError().text();
+            db.rollback();
+            return fail(QString("Record %1: insert failed: %2").arg(i + 2).arg(error));
+        }
+    }
+    if (!db.commit()) {
+        QString error = db.lastError().text();
+        db.rollback();
+        return fail("Commit failed: " + error);
+    }
+
+    result["inserted"] = int(rows.size());
+    result["elapsedMs"] = timer.elapsed();
+    print(result);
+    return 0;
+}
+
+namespace {
+
+const char *benchConnection = "proball_bench";
+
+// Opens (creating if needed) a SQLite file standing in for the Oracle source
+bool openSqlite(const QString &fileName, QString *error)
+{
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", QLatin1String(benchConnection));
+    db.setDatabaseName(fileName);
+    if (!db.open()) {
+        *error = "Cannot open " + fileName + ": " + db.lastError().text();
+        return false;
+    }
+    // Bulk loads of throwaway data need no crash safety
+    QSqlQuery pragma(db);
+    pragma.exec("PRAGMA journal_mode = OFF");
+    pragma.exec("PRAGMA synchronous = OFF");
+    return true;
+}
+
+void closeSqlite()
+{
+    {
+        QSqlDatabase db = QSqlDatabase::database(QLatin1String(benchConnection), false);
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(QLatin1String(benchConnection));
+}
+
+} // namespace
+
+int CommandLine::generate()
+{
+    bool ok = false;
+    const int count = m_arguments.value(0).toInt(&ok);
+    if (!ok || count <= 0)
+        return fail("generate needs a positive number of matches", 2);
+    const QString output = m_parser.value("output");
+    if (output.isEmpty())
+        return fail("generate needs --output FILE.sqlite", 2);
+
+    QElapsedTimer timer;
+    timer.start();
+    const quint32 seed = m_parser.isSet("seed") ? m_parser.value("seed").toUInt() : 1;
+    const QVector<Match> matches = MatchGenerator(seed).generate(count);
+
+    QString error;
+    if (!openSqlite(output, &error))
+        return fail(error);
+    ok = MatchGenerator::createSchema(QSqlDatabase::database(QLatin1String(benchConnection)), &error)
+         && MatchGenerator::insert(QSqlDatabase::database(QLatin1String(benchConnection)), matches, &error);
+    closeSqlite();
+    if (!ok)
+        return fail(error);
+
+    QJsonObject result;
+    result["command"] = "generate";
+    result["output"] = output;
+    result["matches"] = count;
+    result["seed"] = qint64(seed);
+    result["elapsedMs"] = timer.elapsed();
+    print(result);
+    return 0;
+}
+
+int CommandLine::bench()
+{
+    QList<int> sizes;
+    for (const QString &size : m_parser.value("sizes").split(',', Qt::SkipEmptyParts)) {
+        bool ok = false;
+        const int value = size.trimmed().toInt(&ok);
+        if (!ok || value <= 0)
+            return fail("Invalid size: " + size, 2);
+        sizes.append(value);
+    }
+    const int repeat = m_parser.value("repeat").toInt();
+    if (sizes.isEmpty() || repeat <= 0)
+        return fail("bench needs --sizes and a positive --repeat", 2);
+
+    const QStringList phaseNames = {"import", "refresh", "filter", "sort", "stats", "calendar", "dayLookup", "pdf"};
+    const QStringList skipped = m_parser.values("skip");
+    for (const QString &phase : skipped) {
+        if (!phaseNames.contains(phase))
+            return fail("Unknown phase: " + phase, 2);
+    }
+
+    QTemporaryDir dir;
+    if (!dir.isValid())
+        return fail("Cannot create a temporary directory: " + dir.errorString());
+
+    const quint32 seed = m_parser.isSet("seed") ? m_parser.value("seed").toUInt() : 1;
+    QElapsedTimer total;
+    total.start();
+    QJsonArray runs;
+
+    for (int size : std::as_const(sizes)) {
+        QElapsedTimer timer;
+        timer.start();
+        const QVector<Match> generated = MatchGenerator(seed).generate(size);
+        const qint64 generateMs = timer.elapsed();
+
+        const QString fileName = dir.filePath(QString("matches-%1.sqlite").arg(size));
+        QString error;
+        if (!openSqlite(fileName, &error))
+            return fail(error);
+
+        // Every phase runs `repeat` times; a failure aborts the whole run
+        QHash<QString, QList<double>> samples;
+        QJsonObject rows;
+        auto measure = [&](const QString &phase, const std::function<bool()> &work) {
+            if (skipped.contains(phase) || !error.isEmpty())
+                return;
+            QElapsedTimer clock;
+            clock.start();
+            if (work())
+                samples[phase].append(clock.nsecsElapsed() / 1e6);
+            else if (error.isEmpty())
+                error = phase + " failed";
+        };
+
+        QVector<Match> matches = generated;
+        QRandomGenerator dayPicker(seed);
+        for (int run = 0; run < repeat && error.isEmpty(); ++run) {
+            QSqlDatabase db = QSqlDatabase::database(QLatin1String(benchConnection));
+
+            // Bulk import: the CSV import's INSERT in one transaction, into
+            // a table recreated beforehand so DROP/CREATE/INDEX are not timed
+            if (!skipped.contains("import")) {
+                if (!MatchGenerator::createSchema(db, &error))
+                    break;
+                measure("import", [&]() {
+                    return MatchGenerator::insert(db, generated, &error);
+                });
+            } else if (run == 0) {
+                if (!MatchGenerator::createSchema(db, &error) || !MatchGenerator::insert(db, generated, &error))
+                    break;
+            }
+
+            // Table refresh: the full load behind the store and the exports
+            measure("refresh", [&]() {
+                return MatchStore::loadAll(db, matches, &error);
+            });
+
+            // Filter panel: index build plus a venue, date range and attendance query
+            measure("filter", [&]() {
+                MatchFilterEngine engine;
+                engine.setMatches(matches, quint64(run) + 1);
+                MatchFilterCriteria criteria;
+                const QStringList venues = engine.venues();
+                if (!venues.isEmpty())
+                    criteria.venues.insert(venues.first());
+                if (!matches.isEmpty()) {
+                    criteria.from = matches.first().date.date();
+                    criteria.to = criteria.from.addYears(2);
+                }
+                criteria.minSpectateurs = 1000;
+                rows["filter"] = int(engine.evaluate(criteria).size());
+                return true;
+            });
+
+            // Header click: newest first, then by venue
+            measure("sort", [&]() {
+                MatchSortKeys keys;
+                keys.build(matches, quint64(run) + 1);
+                rows["sort"] = int(keys.order({{1, Qt::DescendingOrder}, {2, Qt::AscendingOrder}}).size());
+                return true;
+            });
+
+            // Statistics: the per-type aggregates and a monthly cube rollup
+            measure("stats", [&]() {
+                AttendanceAggregates aggregates(nullptr);
+                aggregates.rebuild(matches);
+                rows["stats"] = int(AttendanceCube::rollup(matches, AttendanceCube::Month).size());
+                return true;
+            });
+
+            // Calendar dialog: every match date into a set
+            measure("calendar", [&]() {
+                ProfiledQuery query("Calendar match dates", db);
+                query.setForwardOnly(true);
+                if (!query.exec("SELECT DATEMATCH FROM MATCHES")) {
+                    error = query.lastError().text();
+                    return false;
+                }
+                QSet<QDate> dates;
+                while (query.next())
+                    dates.insert(query.value(0).toDateTime().date());
+                rows["calendar"] = int(dates.size());
+                return true;
+            });
+
+            // Calendar click: one day's matches, sampled per lookup. The
+            // Oracle-only TRUNC() is replaced by the equivalent date range.
+            if (!skipped.contains("dayLookup") && error.isEmpty() && !matches.isEmpty()) {
+                ProfiledQuery query("Calendar matches by day", db);
+                query.prepare(QString::fromLatin1(MatchStore::selectColumns())
+                              + " WHERE DATEMATCH >= ? AND DATEMATCH < ? ORDER BY DATEMATCH");
+                for (int lookup = 0; lookup < 100; ++lookup) {
+                    const QDate day = matches[dayPicker.bounded(int(matches.size()))].date.date();
+                    QElapsedTimer clock;
+                    clock.start();
+                    query.bindValue(0, QDateTime(day, QTime(0, 0)));
+                    query.bindValue(1, QDateTime(day.addDays(1), QTime(0, 0)));
+                    if (!query.exec()) {
+                        error = query.lastError().text();
+                        break;
+                    }
+                    while (query.next()) {
+                    }
+                    samples["dayLookup"].append(clock.nsecsElapsed() / 1e6);
+                }
+            }
+
+            // PDF export of the whole table, without the page cache
+            measure("pdf", [&]() {
+                QVector<int> order(matches.size());
+                std::iota(order.begin(), order.end(), 0);
+                MatchRowSource source(matches, order, MatchRowSource::defaultHeaders());
+                TableReportWriter writer("Matches Report");
+                if (!writer.writePdf(dir.filePath("matches.pdf"), source)) {
+                    error = writer.errorString();
+                    return false;
+                }
+                rows["pdf"] = writer.pageCount();
+                return true;
+            });
+        }
+
+        const qint64 databaseBytes = QFileInfo(fileName).size();
+        closeSqlite();
+        QFile::remove(fileName);
+        if (!error.isEmpty())
+            return fail(QString("%1 matches: %2").arg(size).arg(error));
+
+        // Per-match cost makes sizes comparable; day lookups are per query
+        QJsonObject phases;
+        for (const QString &phase : phaseNames) {
+            if (!samples.contains(phase))
+                continue;
+            QJsonObject stats = percentiles(samples.value(phase));
+            if (phase != "dayLookup")
+                stats["usPerMatch"] = stats["p50"].toDouble() * 1000.0 / size;
+            phases[phase] = stats;
+        }
+
+        QJsonObject entry;
+        entry["matches"] = size;
+        entry["generateMs"] = generateMs;
+        entry["databaseBytes"] = databaseBytes;
+        entry["phasesMs"] = phases;
+        entry["results"] = rows; // filtered rows, sorted rows, cube cells, calendar days, PDF pages
+        runs.append(entry);
+    }
+
+    QJsonObject result;
+    result["command"] = "bench";
+    result["seed"] = qint64(seed);
+    result["repeat"] = repeat;
+    result["qtVersion"] = QString::fromLatin1(qVersion());
+    result["threads"] = QThread::idealThreadCount();
+    result["sizes"] = runs;
+    result["elapsedMs"] = total.elapsed();
+
+    const QString output = m_parser.value("output");
+    if (output.isEmpty()) {
+        print(result);
+        return 0;
+    }
+    QSaveFile file(output);
+    if (!file.open(QIODevice::WriteOnly) || file.write(QJsonDocument(result).toJson(QJsonDocument::Indented)) < 0
+        || !file.commit())
+        return fail("Cannot write " + output + ": " + file.errorString());
+    return 0;
+}
+
+#ifdef Q_OS_UNIX
+
+namespace {
+
+bool setUpVirtualGate(VirtualGate &gate, const QCommandLineParser &parser, QString *error)
+{
+    VirtualGate::Faults faults;
+    faults.latencyMs = parser.value("latency").toInt();
+    faults.jitterMs = parser.value("jitter").toInt();
+    faults.corruptRate = parser.value("corrupt").toDouble();
+    faults.dropRate = parser.value("drop").toDouble();
+    faults.disconnectAfter = parser.value("disconnect-after").toInt();
+    gate.setFaults(faults);
+    gate.setLegacy(parser.isSet("legacy"));
+    if (parser.isSet("seed"))
+        gate.setSeed(parser.value("seed").toUInt());
+    gate.setTurnstileRate(parser.value("events-per-second").toInt());
+    if (parser.isSet("record") && !gate.startRecording(parser.value("record"), error))
+        return false;
+    return true;
+}
+
+} // namespace
+
+int CommandLine::gateSim()
+{
+    VirtualGate gate(m_parser.value("gate-id"), m_parser.value("lanes").toInt());
+    QString error;
+    if (!setUpVirtualGate(gate, m_parser, &error) || !gate.open(m_parser.value("link"), &error))
+        return fail(error);
+
+    // Announce the port first so that scripts can point PROBALL_GATE_PORTS at it
+    QJsonObject ready;
+    ready["command"] = "gate-sim";
+    ready["port"] = gate.portName();
+    ready["gateId"] = m_parser.value("gate-id");
+    QTextStream(stdout) << QJsonDocument(ready).toJson(QJsonDocument::Compact) << Qt::endl;
+
+    const int duration = m_parser.value("duration").toInt();
+    if (duration > 0)
+        QTimer::singleShot(duration * 1000, QCoreApplication::instance(), &QCoreApplication::quit);
+    QCoreApplication::exec();
+
+    QJsonObject result;
+    result["command"] = "gate-sim";
+    result["framesReceived"] = gate.framesReceived();
+    result["corruptFramesReceived"] = gate.corruptFramesReceived();
+    result["faultsInjected"] = gate.faultsInjected();
+    result["capacity"] = gate.capacity();
+    print(result);
+    return 0;
+}
+
+int CommandLine::gateBench()
+{
+    // Commands to send: a recording, or a ramp of distinct capacities
+    QList<VirtualGate::RecordedCommand> script;
+    if (m_parser.isSet("replay")) {
+        QString error;
+        script = VirtualGate::loadRecording(m_parser.value("replay"), &error);
+        if (!error.isEmpty())
+            return fail(error);
+        if (script.isEmpty())
+            return fail("The recording holds no commands", 2);
+    } else {
+        const int updates = m_parser.value("updates").toInt();
+        const int interval = m_parser.value("interval").toInt();
+        if (updates <= 0 || interval < 0)
+            return fail("gate-bench needs a positive --updates and a non-negative --interval", 2);
+        for (int i = 0; i < updates; ++i)
+            script.append({qint64(i) * interval, BarrierProtocol::capacityFrame(0, 10000 + i)});
+    }
+
+    VirtualGate gate(m_parser.value("gate-id"), m_parser.value("lanes").toInt());
+    QString error;
+    const QString link = m_parser.isSet("link") ? m_parser.value("link")
+                                                : QDir::temp().filePath(QString("proball-gate-%1").arg(getpid()));
+    if (!setUpVirtualGate(gate, m_parser, &error) || !gate.open(link, &error))
+        return fail(error);
+
+    // Latency is measured from the setCapacity() call: once through the
+    // gate applying the value, once through the host seeing the ack
+    struct Issued { int capacity; qint64 atNs; bool applied; bool confirmed; };
+    QList<Issued> issued;
+    QList<double> appliedLatency;
+    QList<double> confirmedLatency;
+    QElapsedTimer clock;
+    int expectedCapacity = -1;
+    int protocol = -1;
+    int reconnects = 0;
+    bool finished = false;
+
+    auto resolve = [&](int capacity, bool Issued::*flag, QList<double> &samples) {
+        // The newest command with this value settles it and everything it superseded
+        const qint64 now = clock.nsecsElapsed();
+        int last = -1;
+        for (int i = int(issued.size()) - 1; i >= 0 && last < 0; --i) {
+            if (issued[i].capacity == capacity && !(issued[i].*flag))
+                last = i;
+        }
+        for (int i = 0; i <= last; ++i) {
+            if (!(issued[i].*flag)) {
+                issued[i].*flag = true;
+                samples.append((now - issued[i].atNs) / 1e6);
+            }
+        }
+    };
+
+    BarrierLink barrier(gate.portName(), m_parser.value("gate-id"), true);
+    int appliedCount = 0;
+    QObject::connect(&gate, &VirtualGate::capacityApplied, [&](int capacity) {
+        appliedCount++;
+        resolve(capacity, &Issued::applied, appliedLatency);
+    });
+    QObject::connect(&gate, &VirtualGate::reconnected, [&]() { reconnects++; });
+    QObject::connect(&barrier, &BarrierLink::capacityConfirmed, [&](int capacity) {
+        resolve(capacity, &Issued::confirmed, confirmedLatency);
+    });
+
+    auto settled = [&]() {
+        if (!finished || gate.capacity() != expectedCapacity)
+            return false;
+        return protocol == 0 || (!issued.isEmpty() && issued.last().confirmed);
+    };
+    QTimer poll;
+    poll.setInterval(10);
+    QObject::connect(&poll, &QTimer::timeout, [&]() {
+        if (settled())
+            QCoreApplication::quit();
+    });
+
+    // Start the clock only once the handshake is done
+    QObject::connect(&barrier, &BarrierLink::identified, [&](const QString &, int, int version) {
+        if (protocol >= 0)
+            return; // identified again after a reconnect
+        protocol = version;
+        clock.start();
+        for (int index = 0; index < script.size(); ++index) {
+            const VirtualGate::RecordedCommand command = script[index];
+            QTimer::singleShot(int(command.atMs), Qt::PreciseTimer, QCoreApplication::instance(), [&, command, index]() {
+                if (command.frame.type == BarrierProtocol::Reset) {
+                    barrier.reset();
+                } else {
+                    const int capacity = BarrierProtocol::capacityFromPayload(command.frame.payload);
+                    issued.append({capacity, clock.nsecsElapsed(), false, false});
+                    expectedCapacity = capacity;
+                    barrier.setCapacity(capacity);
+                }
+                if (index == script.size() - 1)
+                    finished = true;
+            });
+        }
+        poll.start();
+    });
+
+    const int timeout = m_parser.value("timeout").toInt();
+    QTimer::singleShot(timeout * 1000, QCoreApplication::instance(), &QCoreApplication::quit);
+    barrier.start();
+    QCoreApplication::exec();
+
+    const double elapsedMs = clock.isValid() ? clock.nsecsElapsed() / 1e6 : 0.0;
+    QJsonObject result;
+    result["command"] = "gate-bench";
+    result["protocol"] = protocol;
+    result["updates"] = int(issued.size());
+    result["elapsedMs"] = elapsedMs;
+    result["updatesPerSecond"] = elapsedMs > 0 ? issued.size() * 1000.0 / elapsedMs : 0.0;
+    result["appliedLatencyMs"] = percentiles(appliedLatency);
+    result["confirmedLatencyMs"] = percentiles(confirmedLatency);
+    result["applied"] = appliedCount;
+    result["coalesced"] = int(issued.size()) - appliedCount; // superseded before reaching the gate
+    result["framesReceived"] = gate.framesReceived();
+    result["corruptFramesReceived"] = gate.corruptFramesReceived();
+    result["faultsInjected"] = gate.faultsInjected();
+    result["reconnects"] = reconnects;
+    result["expectedCapacity"] = expectedCapacity;
+    result["finalCapacity"] = gate.capacity();
+    result["settled"] = settled();
+    print(result);
+
+    if (protocol < 0)
+        return fail("The virtual gate never completed the handshake");
+    return settled() ? 0 : fail("The gate did not settle on the last capacity within the timeout");
+}
+
+#else
+
+int CommandLine::gateSim()
+{
+    return fail("The virtual gate needs a Unix pseudo-terminal", 2);
+}
+
+int CommandLine::gateBench()
+{
+    return fail("The virtual gate needs a Unix pseudo-terminal", 2);
+}
+
+#endif
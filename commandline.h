@@ -0,0 +1,54 @@
+#ifndef COMMANDLINE_H
+#define COMMANDLINE_H
+
+#include <QCommandLineParser>
+#include <QJsonObject>
+#include <QStringList>
+#include <QVector>
+#include "matches.h"
+
+// Headless entry point for scheduled jobs:
+//   last export --format csv|pdf [--output FILE] [--venue V] [--type T] [--status S] [--from D] [--to D]
+//   last stats [--by type|venue|month|day|weekday|status]
+//   last simulate N [--match ID] [--seed S]
+//   last import FILE.csv [--dry-run]
+//   last generate N --output FILE.sqlite [--seed S]
+//   last bench [--sizes N,N,...] [--repeat N] [--skip PHASE] [--seed S] [--output FILE.json]
+//   last gate-sim [--link PATH] [--gate-id ID] [--lanes N] [--events-per-second N] [fault options]
+//                 [--record FILE] [--duration S]
+//   last gate-bench [--updates N] [--interval MS] [--replay FILE] [fault options]
+// Fault options: --latency MS, --jitter MS, --corrupt P, --drop P, --disconnect-after N, --legacy.
+// Runs on QCoreApplication (QGuiApplication on the offscreen platform for PDF),
+// never builds MainWindow and prints JSON on stdout. Only the gate commands
+// touch serial ports, and only the virtual gate's pseudo-terminal. generate
+// and bench work on a local SQLite file, never on the Oracle database.
+class CommandLine
+{
+public:
+    static bool isCommand(int argc, char *argv[]);
+    static int run(int argc, char *argv[]);
+
+private:
+    explicit CommandLine(const QStringList &arguments);
+
+    int exec();
+    int exportMatches();
+    int stats();
+    int simulate();
+    int importMatches();
+    int generate();
+    int bench();
+    int gateSim();
+    int gateBench();
+
+    bool connect();
+    bool loadMatches(QVector<Match> &matches);
+    int fail(const QString &message, int code = 1) const;
+    void print(const QJsonObject &object) const;
+
+    QCommandLineParser m_parser;
+    QString m_command;
+    QStringList m_arguments; // positional arguments after the command
+};
+
+#endif // COMMANDLINE_H
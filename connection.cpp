@@ -1,17 +1,20 @@
 #include <QDebug>
+#include <QElapsedTimer>
 #include "connection.h"
+#include "queryprofiler.h"
+#include "trace.h"
 
 Connection::Connection()
 {
 }
 
-bool Connection::createconnect()
+bool Connection::createconnect(const QString &connectionName)
 {
     bool test = false;
 
     // Only add the database if it doesn't already exist
-    if (!QSqlDatabase::contains("qt_sql_default_connection")) {
-        QSqlDatabase db = QSqlDatabase::addDatabase("QODBC");
+    if (!QSqlDatabase::contains(connectionName)) {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QODBC", connectionName);
 
         db.setDatabaseName("Source_PRojet2A"); // Insert the name of the data source
         db.setUserName("proballManager"); // Insert the username
@@ -19,7 +22,14 @@ bool Connection::createconnect()
 
         qDebug() << "Attempting to connect to the database...";
 
-        if (db.open()) {
+        PB_TRACE_SCOPE_DETAIL("sql.connect", connectionName);
+        QElapsedTimer timer;
+        timer.start();
+        bool opened = db.open();
+        QueryProfiler::instance().record("CONNECT", QString(), 0, timer.nsecsElapsed() / 1000,
+                                         0, 0, 0, opened);
+
+        if (opened) {
             test = true;
             qDebug() << "Connection successful!";
         } else {
@@ -28,7 +38,7 @@ bool Connection::createconnect()
         }
     } else {
         // Connection already exists, just check if it's open
-        QSqlDatabase db = QSqlDatabase::database("qt_sql_default_connection");
+        QSqlDatabase db = QSqlDatabase::database(connectionName, false);
         if (db.isOpen() || db.open()) {
             test = true;
             qDebug() << "Using existing open connection";
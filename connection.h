@@ -9,7 +9,8 @@ class Connection
 {
 public:
     Connection();
-    bool createconnect();
+    // Opens (or reuses) the named connection in the calling thread
+    bool createconnect(const QString &connectionName = QLatin1String(QSqlDatabase::defaultConnection));
     QSqlDatabase getConnection(); // Added new function to get the connection
 };
 
@@ -0,0 +1,222 @@
+#include "gatemanager.h"
+#include <QDebug>
+#include <QFileInfo>
+#include <QSerialPortInfo>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace {
+
+const int scanIntervalMs = 2000;
+
+} // namespace
+
+GateManager::GateManager(QObject *parent)
+    : QObject(parent), m_totalCapacity(-1)
+{
+    const QString ports = qEnvironmentVariable("PROBALL_GATE_PORTS");
+    for (const QString &port : ports.split(',', Qt::SkipEmptyParts))
+        m_explicitPorts << port.trimmed();
+
+    m_scanTimer.setInterval(scanIntervalMs);
+    connect(&m_scanTimer, &QTimer::timeout, this, &GateManager::scan);
+    connect(&m_scanWatcher, &QFutureWatcher<QList<Candidate>>::finished, this, &GateManager::scanFinished);
+}
+
+GateManager::~GateManager()
+{
+    m_scanTimer.stop();
+    m_scanWatcher.waitForFinished();
+
+    // Each link stops its own thread
+    qDeleteAll(m_gates);
+}
+
+void GateManager::start()
+{
+    scan();
+    m_scanTimer.start();
+}
+
+void GateManager::scan()
+{
+    // Enumeration can take tens of milliseconds on Windows; keep it off the GUI thread
+    if (m_scanWatcher.isRunning())
+        return;
+    m_scanWatcher.setFuture(QtConcurrent::run(&GateManager::findCandidates, m_explicitPorts));
+}
+
+QList<GateManager::Candidate> GateManager::findCandidates(const QStringList &explicitPorts)
+{
+    QList<Candidate> candidates;
+    const auto infos = QSerialPortInfo::availablePorts();
+
+    if (!explicitPorts.isEmpty()) {
+        for (const QString &port : explicitPorts) {
+            Candidate candidate{port, port, QString(), true};
+            bool present = port.startsWith('/') && QFileInfo::exists(port);
+            for (const QSerialPortInfo &info : infos) {
+                if (info.portName() == port || info.systemLocation() == port) {
+                    present = true;
+                    candidate.description = info.description();
+                    if (!info.serialNumber().isEmpty())
+                        candidate.fallbackId = info.serialNumber();
+                }
+            }
+            if (present)
+                candidates.append(candidate);
+        }
+        return candidates;
+    }
+
+    // No fallback to an arbitrary port: a wrong device is worse than no gate
+    for (const QSerialPortInfo &info : infos) {
+        if (info.description().contains("Arduino", Qt::CaseInsensitive) ||
+            info.manufacturer().contains("Arduino", Qt::CaseInsensitive) ||
+            info.description().contains("CH340", Qt::CaseInsensitive) ||  // Common Arduino clone chip
+            info.description().contains("USB Serial", Qt::CaseInsensitive)) {  // Generic descriptor often used
+            // Serial number survives replugging into another USB port; the port name does not
+            const QString fallbackId = info.serialNumber().isEmpty() ? info.portName() : info.serialNumber();
+            candidates.append({info.portName(), fallbackId, info.description(), false});
+        }
+    }
+    return candidates;
+}
+
+void GateManager::scanFinished()
+{
+    const QList<Candidate> candidates = m_scanWatcher.result();
+
+    QSet<QString> present;
+    bool changed = false;
+    for (const Candidate &candidate : candidates) {
+        present.insert(candidate.portName);
+        if (!m_gates.contains(candidate.portName)) {
+            addGate(candidate);
+            changed = true;
+        }
+    }
+
+    const QStringList known = m_gates.keys();
+    for (const QString &portName : known) {
+        if (!present.contains(portName)) {
+            removeGate(portName);
+            changed = true;
+        }
+    }
+
+    if (changed) {
+        distribute();
+        emit gatesChanged();
+    }
+    emit scanCompleted();
+}
+
+void GateManager::addGate(const Candidate &candidate)
+{
+    qDebug() << "Gate controller plugged in:" << candidate.portName << candidate.description << candidate.fallbackId;
+
+    BarrierLink *link = new BarrierLink(candidate.portName, candidate.fallbackId, candidate.configured);
+    m_gates.insert(candidate.portName, link);
+
+    connect(link, &BarrierLink::identified, this, [this]() {
+        distribute();
+        emit gatesChanged();
+    });
+    connect(link, &BarrierLink::connectionChanged, this, [this](bool connected) {
+        // A gate that drops out hands its share to the others until it is back
+        if (connected)
+            return;
+        distribute();
+        emit gatesChanged();
+    });
+    connect(link, &BarrierLink::capacityConfirmed, this, [this, link](int capacity, int roundTripMs) {
+        emit capacityConfirmed(link->gateId(), capacity, roundTripMs);
+    });
+    connect(link, &BarrierLink::errorOccurred, this, [this, link](const QString &message) {
+        emit errorOccurred(link->gateId(), message);
+    });
+
+    link->start();
+}
+
+void GateManager::removeGate(const QString &portName)
+{
+    qDebug() << "Gate controller removed:" << portName;
+    delete m_gates.take(portName);
+}
+
+int GateManager::connectedGates() const
+{
+    int count = 0;
+    for (BarrierLink *link : m_gates) {
+        if (link->isConnected() && link->isIdentified())
+            count++;
+    }
+    return count;
+}
+
+QList<int> GateManager::splitCapacity(int total, const QList<int> &weights)
+{
+    QList<int> shares(weights.size(), 0);
+    qint64 weightSum = 0;
+    for (int weight : weights)
+        weightSum += weight;
+    if (weightSum <= 0 || total <= 0)
+        return shares;
+
+    // Floor of each exact share, then hand out the remainder by largest fraction
+    QList<QPair<qint64, int>> remainders;
+    int assigned = 0;
+    for (int i = 0; i < weights.size(); ++i) {
+        const qint64 exact = qint64(total) * weights[i];
+        shares[i] = int(exact / weightSum);
+        assigned += shares[i];
+        remainders.append(qMakePair(exact % weightSum, i));
+    }
+    std::stable_sort(remainders.begin(), remainders.end(), [](const QPair<qint64, int> &a, const QPair<qint64, int> &b) {
+        return a.first > b.first;
+    });
+    for (int i = 0; i < total - assigned; ++i)
+        shares[remainders[i % remainders.size()].second]++;
+    return shares;
+}
+
+void GateManager::distribute()
+{
+    if (m_totalCapacity < 0)
+        return;
+
+    // Stable order by gate id so that remainders always land on the same gates
+    QList<BarrierLink *> active;
+    for (BarrierLink *link : std::as_const(m_gates)) {
+        if (link->isConnected() && link->isIdentified())
+            active.append(link);
+    }
+    std::sort(active.begin(), active.end(), [](BarrierLink *a, BarrierLink *b) {
+        return a->gateId() < b->gateId();
+    });
+
+    QList<int> weights;
+    for (BarrierLink *link : std::as_const(active))
+        weights.append(link->lanes());
+    const QList<int> shares = splitCapacity(m_totalCapacity, weights);
+
+    // Each link coalesces on its own thread; unchanged shares are dropped there
+    for (int i = 0; i < active.size(); ++i)
+        active[i]->setCapacity(shares[i]);
+}
+
+void GateManager::setCapacity(int totalCapacity)
+{
+    m_totalCapacity = qMax(0, totalCapacity);
+    if (connectedGates() == 0)
+        qDebug() << "No gate controller connected; capacity" << m_totalCapacity << "will be sent when one appears";
+    distribute();
+}
+
+void GateManager::reset()
+{
+    for (BarrierLink *link : std::as_const(m_gates))
+        link->reset();
+}
@@ -0,0 +1,72 @@
+#ifndef GATEMANAGER_H
+#define GATEMANAGER_H
+
+#include <QObject>
+#include <QFutureWatcher>
+#include <QList>
+#include <QMap>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+#include "barrierlink.h"
+
+// Finds the stadium's gate controllers and keeps one BarrierLink per gate.
+// Serial ports are rescanned off the GUI thread every few seconds, so gates
+// can be plugged in or pulled out at any time. A match capacity is split
+// across the identified gates in proportion to their lanes.
+//
+// Candidate ports are those that look like an Arduino or a USB serial
+// adapter; PROBALL_GATE_PORTS (comma separated port names or paths)
+// replaces the detection for installations with other adapters and for
+// virtual gates, which the system enumeration does not list. A detected
+// port only becomes a gate once it answers Hello; a silent legacy gate is
+// accepted only on a port listed in PROBALL_GATE_PORTS.
+class GateManager : public QObject
+{
+    Q_OBJECT
+public:
+    explicit GateManager(QObject *parent = nullptr);
+    ~GateManager();
+
+    void start();
+    void setCapacity(int totalCapacity);
+    void reset();
+
+    QList<BarrierLink *> gates() const { return m_gates.values(); }
+    int connectedGates() const;
+
+    // Largest-remainder split of total across weights; sums to total exactly
+    static QList<int> splitCapacity(int total, const QList<int> &weights);
+
+signals:
+    void gatesChanged();
+    void scanCompleted();
+    void capacityConfirmed(const QString &gateId, int capacity, int roundTripMs);
+    void errorOccurred(const QString &gateId, const QString &message);
+
+private slots:
+    void scan();
+    void scanFinished();
+
+private:
+    struct Candidate
+    {
+        QString portName;
+        QString fallbackId;
+        QString description;
+        bool configured; // listed in PROBALL_GATE_PORTS, so a silent device is a legacy gate
+    };
+
+    static QList<Candidate> findCandidates(const QStringList &explicitPorts);
+    void addGate(const Candidate &candidate);
+    void removeGate(const QString &portName);
+    void distribute();
+
+    QMap<QString, BarrierLink *> m_gates; // by port name
+    QStringList m_explicitPorts;
+    QTimer m_scanTimer;
+    QFutureWatcher<QList<Candidate>> m_scanWatcher;
+    int m_totalCapacity; // -1 until a match is selected
+};
+
+#endif // GATEMANAGER_H
@@ -1,33 +1,193 @@
 #include "hologrambar.h"
+#include "trace.h"
 #include <QGraphicsSceneHoverEvent>
-#include <QTimer>
-#include <QGraphicsDropShadowEffect>
+#include <QPixmapCache>
+#include <QtMath>
+#include <QEvent>
+#include <QWidget>
+#include <QWheelEvent>
+#include <QStyleOptionGraphicsItem>
+
+// HologramClock implementation
+HologramClock *HologramClock::shared() {
+    static HologramClock *clock = new HologramClock();
+    return clock;
+}
+
+HologramClock::HologramClock() {
+    // Same glow as the former per-bar animation
+    m_animation.setDuration(1500);
+    m_animation.setStartValue(0.7);
+    m_animation.setEndValue(1.0);
+    m_animation.setLoopCount(-1); // Infinite loop
+    m_animation.setEasingCurve(QEasingCurve::InOutSine);
+    connect(&m_animation, &QVariantAnimation::valueChanged, this, [this](const QVariant &value) {
+        const qreal opacity = value.toReal();
+        for (HologramBar *bar : std::as_const(m_bars))
+            bar->setOpacity(opacity);
+    });
+}
+
+void HologramClock::addBar(HologramBar *bar) {
+    m_bars.insert(bar);
+    bar->setOpacity(m_animation.state() == QAbstractAnimation::Stopped ? 1.0 : glow());
+    updateRunning();
+}
+
+void HologramClock::removeBar(HologramBar *bar) {
+    m_bars.remove(bar);
+    updateRunning();
+}
+
+void HologramClock::attachView(QWidget *view) {
+    view->installEventFilter(this);
+    // Minimising keeps the view "visible"; its window reports the state change
+    view->window()->installEventFilter(this);
+    m_views.append(view);
+    updateRunning();
+}
+
+bool HologramClock::eventFilter(QObject *watched, QEvent *event) {
+    if (event->type() == QEvent::Show || event->type() == QEvent::Hide
+        || event->type() == QEvent::WindowStateChange)
+        QMetaObject::invokeMethod(this, [this]() { updateRunning(); }, Qt::QueuedConnection);
+    return QObject::eventFilter(watched, event);
+}
+
+void HologramClock::updateRunning() {
+    bool visible = false;
+    for (int i = m_views.size() - 1; i >= 0; --i) {
+        if (m_views[i].isNull())
+            m_views.removeAt(i);
+        else if (m_views[i]->isVisible() && !m_views[i]->window()->isMinimized())
+            visible = true;
+    }
+
+    const bool run = !m_bars.isEmpty() && visible;
+    if (run && m_animation.state() == QAbstractAnimation::Stopped)
+        m_animation.start();
+    else if (run && m_animation.state() == QAbstractAnimation::Paused)
+        m_animation.resume();
+    else if (!run && m_animation.state() == QAbstractAnimation::Running)
+        m_animation.pause();
+    if (m_bars.isEmpty())
+        m_animation.stop();
+}
 
 // HologramBar implementation
 HologramBar::HologramBar(const QString &label, double value, int count, QGraphicsItem *parent)
-    : QObject(nullptr), QGraphicsRectItem(parent), m_label(label), m_value(value), m_count(count), m_opacity(1.0) {
+    : QObject(nullptr), QGraphicsRectItem(parent), m_label(label), m_value(value), m_count(count),
+      m_gradient(0, 0, 0, 100), m_glowPen(QColor(0, 220, 255, 200), 2),
+      m_glowItem(nullptr), m_hoverProgress(0.0), m_glowEnabled(true), m_reflection(nullptr),
+      m_fromValue(value), m_toValue(value) {
     // Set up the hologram appearance
     setPen(Qt::NoPen);
     // Create holographic effect with gradient
-    m_gradient = new QLinearGradient(0, 0, 0, 100);
-    m_gradient->setColorAt(0.0, QColor(0, 200, 255, 180));
-    m_gradient->setColorAt(0.5, QColor(0, 150, 255, 150));
-    m_gradient->setColorAt(1.0, QColor(0, 100, 200, 180));
+    m_gradient.setColorAt(0.0, QColor(0, 200, 255, 180));
+    m_gradient.setColorAt(0.5, QColor(0, 150, 255, 150));
+    m_gradient.setColorAt(1.0, QColor(0, 100, 200, 180));
+    // Fonts are built once instead of on every paint
+    m_labelFont.setBold(true);
+    m_valueFont = m_labelFont;
+    m_valueFont.setPointSize(12);
+    m_countFont = m_labelFont;
+    m_countFont.setPointSize(9);
+    // The content is static: paint it once into a device pixmap and let the
+    // glow only change the opacity it is blitted with
+    setCacheMode(QGraphicsItem::DeviceCoordinateCache);
     // Enable hover events
     setAcceptHoverEvents(true);
-    // Initialize animation
-    m_glowAnimation = new QPropertyAnimation(this, "opacity");
-    m_glowAnimation->setDuration(1500);
-    m_glowAnimation->setStartValue(0.7);
-    m_glowAnimation->setEndValue(1.0);
-    m_glowAnimation->setLoopCount(-1); // Infinite loop
-    m_glowAnimation->setEasingCurve(QEasingCurve::InOutSine);
-    m_glowAnimation->start();
+    // One hover animation, reversed on leave instead of recreated
+    m_hoverAnimation = new QPropertyAnimation(this, "hoverProgress", this);
+    m_hoverAnimation->setDuration(300);
+    m_hoverAnimation->setStartValue(0.0);
+    m_hoverAnimation->setEndValue(1.0);
+    // Value changes ease in rather than jump
+    m_valueAnimation = new QVariantAnimation(this);
+    m_valueAnimation->setDuration(600);
+    m_valueAnimation->setStartValue(0.0);
+    m_valueAnimation->setEndValue(1.0);
+    m_valueAnimation->setEasingCurve(QEasingCurve::OutCubic);
+    connect(m_valueAnimation, &QVariantAnimation::valueChanged, this, [this](const QVariant &progress) {
+        const qreal t = progress.toReal();
+        m_value = m_fromValue + (m_toValue - m_fromValue) * t;
+        setBarRect(QRectF(m_fromRect.topLeft() + (m_toRect.topLeft() - m_fromRect.topLeft()) * t,
+                          m_fromRect.size() + (m_toRect.size() - m_fromRect.size()) * t));
+        update();
+    });
+    // Glow driven by the shared clock
+    HologramClock::shared()->addBar(this);
 }
 
 HologramBar::~HologramBar() {
-    delete m_gradient;
-    delete m_glowAnimation;
+    HologramClock::shared()->removeBar(this);
+}
+
+void HologramBar::setBarRect(const QRectF &rect) {
+    setRect(rect);
+    updateReflection();
+    if (m_glowItem && m_glowItem->isVisible())
+        updateGlowItem();
+}
+
+void HologramBar::animateTo(double value, int count, const QRectF &rect) {
+    m_count = count;
+    if (qFuzzyCompare(value + 1.0, m_toValue + 1.0) && rect == m_toRect && m_valueAnimation->state() == QAbstractAnimation::Running)
+        return;
+    if (qFuzzyCompare(value + 1.0, m_value + 1.0) && rect == this->rect()) {
+        update(); // the count may have changed
+        return;
+    }
+
+    // Start from wherever the bar is now, even mid-animation
+    m_valueAnimation->stop();
+    m_fromValue = m_value;
+    m_toValue = value;
+    m_fromRect = this->rect();
+    m_toRect = rect;
+    m_valueAnimation->start();
+}
+
+void HologramBar::setReflectionEnabled(bool enabled) {
+    if (enabled == (m_reflection != nullptr))
+        return;
+    if (!enabled) {
+        delete m_reflection;
+        m_reflection = nullptr;
+        return;
+    }
+    m_reflection = new QGraphicsEllipseItem(this);
+    m_reflection->setPen(Qt::NoPen);
+    m_reflection->setAcceptedMouseButtons(Qt::NoButton);
+    updateReflection();
+}
+
+void HologramBar::updateReflection() {
+    if (!m_reflection)
+        return;
+
+    // Same reflection as the stats dialog always drew, below the bar
+    const QRectF r = rect();
+    const qreal diameter = r.width();
+    const QPointF center = r.center();
+    m_reflection->setRect(center.x() - diameter / 4, center.y() + diameter / 2 + 10, diameter / 2, diameter / 5);
+
+    QLinearGradient reflectionGradient(0, center.y() + diameter / 2, 0, center.y() + diameter / 2 + diameter / 5);
+    reflectionGradient.setColorAt(0.0, QColor(0, 200, 255, 100));
+    reflectionGradient.setColorAt(1.0, QColor(0, 100, 200, 0));
+    m_reflection->setBrush(reflectionGradient);
+}
+
+void HologramBar::setGlowEnabled(bool enabled) {
+    if (enabled == m_glowEnabled)
+        return;
+    m_glowEnabled = enabled;
+    if (enabled) {
+        HologramClock::shared()->addBar(this);
+    } else {
+        HologramClock::shared()->removeBar(this);
+        setOpacity(1.0);
+    }
 }
 
 QRectF HologramBar::boundingRect() const {
@@ -35,12 +195,8 @@ QRectF HologramBar::boundingRect() const {
 }
 
 void HologramBar::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) {
-    Q_UNUSED(option); // Mark unused parameter
+    PB_TRACE_SCOPE("paint.hologram-bar");
     Q_UNUSED(widget); // Mark unused parameter
-    painter->setRenderHint(QPainter::Antialiasing);
-
-    // Set the opacity for the painter
-    painter->setOpacity(m_opacity); // Use the opacity value
 
     // Get the rect for drawing
     QRectF r = rect();
@@ -48,79 +204,208 @@ void HologramBar::paint(QPainter *painter, const QStyleOptionGraphicsItem *optio
     // Check if we should draw as a circle (width and height similar)
     bool isCircular = qAbs(r.width() - r.height()) < 10;
 
+    // Level of detail: how big the bar is on screen
+    const qreal screenSize = qMin(r.width(), r.height())
+                           * option->levelOfDetailFromTransform(painter->worldTransform());
+    if (screenSize < 24) {
+        // A few pixels wide: a flat mark is all that can be seen
+        painter->setPen(Qt::NoPen);
+        painter->setBrush(QColor(0, 170, 255, 200));
+        if (isCircular)
+            painter->drawEllipse(r);
+        else
+            painter->drawRect(r);
+        return;
+    }
+
+    painter->setRenderHint(QPainter::Antialiasing);
+
     // Draw the bar with gradient as a circle or rounded rectangle
-    painter->setBrush(QBrush(*m_gradient));
+    painter->setBrush(QBrush(m_gradient));
 
     if (isCircular) {
         // Draw as a circle
         painter->drawEllipse(r);
 
         // Draw glowing border
-        QPen glowPen(QColor(0, 220, 255, 200), 2);
-        painter->setPen(glowPen);
+        painter->setPen(m_glowPen);
         painter->drawEllipse(r);
     } else {
         // Draw as rounded rectangle for backward compatibility
         painter->drawRoundedRect(r, 20, 20);
 
         // Draw glowing border
-        QPen glowPen(QColor(0, 220, 255, 200), 2);
-        painter->setPen(glowPen);
+        painter->setPen(m_glowPen);
         painter->drawRoundedRect(r, 20, 20);
     }
 
+    // Text is unreadable below this size
+    if (screenSize < 70)
+        return;
+
     // Draw the label
     painter->setPen(Qt::white);
-    QFont font = painter->font();
-    font.setBold(true);
-    painter->setFont(font);
+    painter->setFont(m_labelFont);
 
     // Draw match type at the bottom
     painter->drawText(r.adjusted(5, 5, -5, -30), Qt::AlignBottom | Qt::AlignHCenter, m_label);
 
     // Draw attendance value
-    font.setPointSize(12);
-    painter->setFont(font);
+    painter->setFont(m_valueFont);
     painter->drawText(r.adjusted(5, 5, -5, -60), Qt::AlignCenter,
                       QString::number(m_value, 'f', 2));
 
     // Draw match count
-    font.setPointSize(9);
-    painter->setFont(font);
+    painter->setFont(m_countFont);
     painter->drawText(r.adjusted(5, 40, -5, -5), Qt::AlignCenter,
                       QString("Count: %1").arg(m_count));
 }
 
+QPixmap HologramBar::glowSprite(const QSizeF &size, bool circular, const QColor &color, int blurRadius) {
+    // Bucket sizes to 16 px so bars of similar size share one sprite
+    const int width = (qCeil(size.width()) + 15) / 16 * 16;
+    const int height = (qCeil(size.height()) + 15) / 16 * 16;
+    const QString key = QString("hologram-glow:%1x%2:%3:%4:%5")
+                            .arg(width).arg(height).arg(circular).arg(color.rgba(), 8, 16).arg(blurRadius);
+
+    QPixmap sprite;
+    if (QPixmapCache::find(key, &sprite))
+        return sprite;
+
+    // Shape mask with room for the blur on every side
+    const int pad = blurRadius * 2;
+    QImage mask(width + 2 * pad, height + 2 * pad, QImage::Format_Alpha8);
+    mask.fill(0);
+    {
+        QPainter painter(&mask);
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(Qt::white);
+        QRectF shape(pad, pad, width, height);
+        if (circular)
+            painter.drawEllipse(shape);
+        else
+            painter.drawRoundedRect(shape, 20, 20);
+    }
+
+    // Three box blurs approximate a Gaussian of the same radius
+    const int box = qMax(1, blurRadius / 3);
+    QVector<int> line;
+    for (int pass = 0; pass < 3; ++pass) {
+        for (int vertical = 0; vertical < 2; ++vertical) {
+            const int lines = vertical ? mask.width() : mask.height();
+            const int length = vertical ? mask.height() : mask.width();
+            line.resize(length);
+            for (int l = 0; l < lines; ++l) {
+                auto pixel = [&](int i) -> uchar & {
+                    return vertical ? mask.scanLine(i)[l] : mask.scanLine(l)[i];
+                };
+                for (int i = 0; i < length; ++i)
+                    line[i] = pixel(i);
+                int sum = 0;
+                for (int i = -box; i <= box; ++i)
+                    sum += line[qBound(0, i, length - 1)];
+                for (int i = 0; i < length; ++i) {
+                    pixel(i) = uchar(sum / (2 * box + 1));
+                    sum += line[qMin(i + box + 1, length - 1)] - line[qMax(i - box, 0)];
+                }
+            }
+        }
+    }
+
+    // Colourise the blurred mask
+    QImage glow(mask.size(), QImage::Format_ARGB32_Premultiplied);
+    glow.fill(color);
+    {
+        QPainter painter(&glow);
+        painter.setCompositionMode(QPainter::CompositionMode_DestinationIn);
+        painter.drawImage(0, 0, mask);
+    }
+
+    sprite = QPixmap::fromImage(glow);
+    QPixmapCache::insert(key, sprite);
+    return sprite;
+}
+
+void HologramBar::updateGlowItem() {
+    if (m_glowItem && m_glowRect == rect())
+        return;
+
+    const int blurRadius = 20;
+    const QRectF r = rect();
+    const bool isCircular = qAbs(r.width() - r.height()) < 10;
+    QPixmap sprite = glowSprite(r.size(), isCircular, QColor(0, 200, 255, 255), blurRadius);
+
+    if (!m_glowItem) {
+        m_glowItem = new QGraphicsPixmapItem(this);
+        m_glowItem->setFlag(QGraphicsItem::ItemStacksBehindParent);
+        m_glowItem->setTransformationMode(Qt::SmoothTransformation);
+        m_glowItem->setAcceptedMouseButtons(Qt::NoButton);
+        m_glowItem->setAcceptHoverEvents(false);
+        m_glowItem->setVisible(false);
+    }
+    m_glowItem->setPixmap(sprite);
+
+    // The sprite is bucketed; stretch it so the shape lines up with the bar
+    const int pad = blurRadius * 2;
+    const qreal sx = r.width() / (sprite.width() - 2 * pad);
+    const qreal sy = r.height() / (sprite.height() - 2 * pad);
+    m_glowItem->setTransform(QTransform::fromScale(sx, sy));
+    m_glowItem->setPos(r.left() - pad * sx, r.top() - pad * sy);
+    m_glowRect = r;
+}
+
+void HologramBar::setHoverProgress(qreal progress) {
+    m_hoverProgress = progress;
+    QGraphicsItem::setScale(1.0 + 0.05 * progress);
+    if (m_glowItem) {
+        m_glowItem->setOpacity(progress);
+        m_glowItem->setVisible(progress > 0.0);
+    }
+}
+
 void HologramBar::hoverEnterEvent(QGraphicsSceneHoverEvent *event) {
-    // Create glow effect when hovering
-    QGraphicsDropShadowEffect *glowEffect = new QGraphicsDropShadowEffect();
-    glowEffect->setColor(QColor(0, 200, 255, 255));
-    glowEffect->setBlurRadius(20);
-    glowEffect->setOffset(0);
-    setGraphicsEffect(glowEffect);
-
-    // Now we can animate the scale property correctly
-    QPropertyAnimation *scaleAnimation = new QPropertyAnimation(this, "scale");
-    scaleAnimation->setDuration(300);
-    scaleAnimation->setStartValue(1.0);
-    scaleAnimation->setEndValue(1.05);
-    scaleAnimation->start(QAbstractAnimation::DeleteWhenStopped);
+    // Glow halo from the sprite cache, faded in with the zoom
+    updateGlowItem();
+    m_hoverAnimation->setDirection(QAbstractAnimation::Forward);
+    if (m_hoverAnimation->state() != QAbstractAnimation::Running)
+        m_hoverAnimation->start();
 
     QGraphicsRectItem::hoverEnterEvent(event);
 }
 
 void HologramBar::hoverLeaveEvent(QGraphicsSceneHoverEvent *event) {
-    // Remove glow effect when not hovering
-    QPropertyAnimation *scaleAnimation = new QPropertyAnimation(this, "scale");
-    scaleAnimation->setDuration(300);
-    scaleAnimation->setStartValue(1.05);
-    scaleAnimation->setEndValue(1.0);
-    scaleAnimation->start(QAbstractAnimation::DeleteWhenStopped);
-
-    // Delay the removal of the glow effect
-    QTimer::singleShot(300, this, [this]() {
-        setGraphicsEffect(nullptr);
-    });
+    // Play the same animation backwards from wherever it is
+    m_hoverAnimation->setDirection(QAbstractAnimation::Backward);
+    if (m_hoverAnimation->state() != QAbstractAnimation::Running)
+        m_hoverAnimation->start();
 
     QGraphicsRectItem::hoverLeaveEvent(event);
 }
+
+// HologramView implementation
+HologramView::HologramView(QWidget *parent)
+    : QGraphicsView(parent) {
+    setDragMode(QGraphicsView::ScrollHandDrag);
+    setTransformationAnchor(QGraphicsView::AnchorUnderMouse);
+    setResizeAnchor(QGraphicsView::AnchorViewCenter);
+    setViewportUpdateMode(QGraphicsView::SmartViewportUpdate);
+    setOptimizationFlags(QGraphicsView::DontSavePainterState | QGraphicsView::DontAdjustForAntialiasing);
+}
+
+void HologramView::zoomBy(qreal factor) {
+    // Keep the zoom between "whole season on screen" and "one bar fills it"
+    const qreal current = transform().m11();
+    const qreal target = qBound(0.01, current * factor, 8.0);
+    scale(target / current, target / current);
+}
+
+void HologramView::fitScene() {
+    fitInView(sceneRect(), Qt::KeepAspectRatio);
+    zoomBy(1.0); // clamp
+}
+
+void HologramView::wheelEvent(QWheelEvent *event) {
+    zoomBy(qPow(1.0015, event->angleDelta().y()));
+    event->accept();
+}
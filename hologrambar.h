@@ -1,27 +1,63 @@
 #ifndef HOLOGRAMBAR_H
 #define HOLOGRAMBAR_H
 #include <QGraphicsRectItem>
+#include <QGraphicsPixmapItem>
+#include <QPixmap>
 #include <QObject>
 #include <QPainter>
 #include <QLinearGradient>
 #include <QPropertyAnimation>
+#include <QVariantAnimation>
+#include <QPointer>
+#include <QSet>
+#include <QList>
+#include <QFont>
+
+#include <QGraphicsView>
+
+class HologramBar;
+
+// One glow animation shared by every HologramBar: a single timer whatever the
+// number of bars. It only runs while bars exist and one of the attached views
+// is visible, so a hidden or minimised dialog costs no CPU.
+class HologramClock : public QObject {
+    Q_OBJECT
+public:
+    static HologramClock *shared();
+
+    void addBar(HologramBar *bar);
+    void removeBar(HologramBar *bar);
+    void attachView(QWidget *view); // pauses the glow while this view is hidden or minimised
+    qreal glow() const { return m_animation.currentValue().toReal(); }
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    HologramClock();
+    void updateRunning();
+
+    QVariantAnimation m_animation;
+    QSet<HologramBar *> m_bars;
+    QList<QPointer<QWidget>> m_views;
+};
 
 class HologramBar : public QObject, public QGraphicsRectItem {
     Q_OBJECT
     Q_PROPERTY(qreal opacity READ opacity WRITE setOpacity) // Opacity property
     Q_PROPERTY(qreal scale READ scale WRITE setScale) // Add scale property
+    Q_PROPERTY(qreal hoverProgress READ hoverProgress WRITE setHoverProgress) // 0 idle, 1 hovered
+    Q_PROPERTY(QRectF barRect READ rect WRITE setBarRect)
 public:
     HologramBar(const QString &label, double value, int count, QGraphicsItem *parent = nullptr);
     ~HologramBar();
     QRectF boundingRect() const override;
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget = nullptr) override;
 
-    // Opacity property
-    qreal opacity() const { return m_opacity; }
-    void setOpacity(qreal opacity) {
-        m_opacity = opacity;
-        update();
-    }
+    // Opacity property: item opacity is applied when the cached pixmap is
+    // blitted, so the glow never repaints the bar itself
+    qreal opacity() const { return QGraphicsItem::opacity(); }
+    void setOpacity(qreal opacity) { QGraphicsItem::setOpacity(opacity); }
 
     // Scale property (this just uses the existing QGraphicsItem::scale functions)
     qreal scale() const { return QGraphicsItem::scale(); }
@@ -30,16 +66,65 @@ public:
         update();
     }
 
+    double value() const { return m_value; }
+    int count() const { return m_count; }
+
+    // Geometry change that keeps the glow halo and reflection in step
+    void setBarRect(const QRectF &rect);
+    // Animates the value and geometry of this bar only; no-op when unchanged
+    void animateTo(double value, int count, const QRectF &rect);
+    // Small gradient ellipse under the bar
+    void setReflectionEnabled(bool enabled);
+
+    // Large scenes switch the shared glow off: thousands of opacity updates per frame
+    void setGlowEnabled(bool enabled);
+
+    // Hover progress drives both the zoom and the glow halo
+    qreal hoverProgress() const { return m_hoverProgress; }
+    void setHoverProgress(qreal progress);
+
+    // Blurred halo for a shape, pre-rendered once per size/colour bucket
+    static QPixmap glowSprite(const QSizeF &size, bool circular, const QColor &color, int blurRadius);
+
 protected:
     void hoverEnterEvent(QGraphicsSceneHoverEvent *event) override;
     void hoverLeaveEvent(QGraphicsSceneHoverEvent *event) override;
 
 private:
+    void updateGlowItem();
+    void updateReflection();
+
     QString m_label;
     double m_value;
     int m_count;
-    QLinearGradient *m_gradient;
-    QPropertyAnimation *m_glowAnimation;
-    qreal m_opacity; // Variable to hold opacity value
+    QLinearGradient m_gradient;
+    QPen m_glowPen;
+    QFont m_labelFont;
+    QFont m_valueFont;
+    QFont m_countFont;
+    QGraphicsPixmapItem *m_glowItem;
+    QRectF m_glowRect; // rect the halo was built for
+    QPropertyAnimation *m_hoverAnimation;
+    qreal m_hoverProgress;
+    bool m_glowEnabled;
+    QGraphicsEllipseItem *m_reflection;
+    QVariantAnimation *m_valueAnimation;
+    double m_fromValue;
+    double m_toValue;
+    QRectF m_fromRect;
+    QRectF m_toRect;
+};
+
+// View for hologram scenes: wheel zooms around the cursor, drag pans. Only
+// items in the exposed area are drawn (the scene's BSP index does the
+// culling) and bars simplify themselves when they are small on screen.
+class HologramView : public QGraphicsView {
+public:
+    explicit HologramView(QWidget *parent = nullptr);
+    void zoomBy(qreal factor);
+    void fitScene(); // whole scene in view, within the zoom limits
+
+protected:
+    void wheelEvent(QWheelEvent *event) override;
 };
 #endif // HOLOGRAMBAR_H
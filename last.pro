@@ -1,5 +1,5 @@
 QT  += core gui sql
-QT += printsupport
+QT += printsupport concurrent svg
 QT += core gui serialport
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -10,17 +10,77 @@ CONFIG += c++17
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    attendancecube.cpp \
+    attendancestats.cpp \
+    barrierlink.cpp \
+    barrierprotocol.cpp \
+    commandline.cpp \
     connection.cpp \
+    gatemanager.cpp \
     hologrambar.cpp \
     main.cpp \
     mainwindow.cpp \
-    matches.cpp
+    matches.cpp \
+    matchfilter.cpp \
+    matchfilterproxy.cpp \
+    matchgenerator.cpp \
+    matchsimulation.cpp \
+    matchsort.cpp \
+    queryprofiler.cpp \
+    reportbatch.cpp \
+    reportcache.cpp \
+    reportjobs.cpp \
+    reportwriter.cpp \
+    searchindex.cpp \
+    stalldetector.cpp \
+    startuptimeline.cpp \
+    statsdashboard.cpp \
+    telemetry.cpp \
+    trace.cpp
 
 HEADERS += \
+    attendancecube.h \
+    attendancestats.h \
+    barrierlink.h \
+    barrierprotocol.h \
+    commandline.h \
     connection.h \
+    gatemanager.h \
     hologrambar.h \
     mainwindow.h \
-    matches.h
+    matches.h \
+    matchfilter.h \
+    matchfilterproxy.h \
+    matchgenerator.h \
+    matchsimulation.h \
+    matchsort.h \
+    queryprofiler.h \
+    reportbatch.h \
+    reportcache.h \
+    reportjobs.h \
+    reportwriter.h \
+    searchindex.h \
+    stalldetector.h \
+    startuptimeline.h \
+    statsdashboard.h \
+    telemetry.h \
+    trace.h
+
+# Trace spans (trace.h) are compiled in with: qmake CONFIG+=tracing
+tracing: DEFINES += PROBALL_TRACING
+
+# Symbolised stacks in stall reports
+linux {
+    QMAKE_LFLAGS += -rdynamic
+    LIBS += -ldl
+}
+win32: LIBS += -ldbghelp
+
+# The virtual gate controller needs a pseudo-terminal
+unix {
+    SOURCES += virtualgate.cpp
+    HEADERS += virtualgate.h
+}
 
 FORMS += \
     mainwindow.ui
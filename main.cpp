@@ -1,26 +1,34 @@
 #include "mainwindow.h"
 #include <QApplication>
-#include <QMessageBox>
-#include "connection.h"
+#include <QTimer>
+#include "commandline.h"
+#include "stalldetector.h"
+#include "startuptimeline.h"
+#include "trace.h"
 int main(int argc, char *argv[])
 {
-    QApplication a(argc, argv);
-    MainWindow w;
-    Connection c;
-    bool test=c.createconnect();
-    if(test)
-    {w.show();
-        QMessageBox::information(nullptr, QObject::tr("database is open"),
-                                 QObject::tr("connection successful.\n"
-                                             "Click Cancel to exit."), QMessageBox::Cancel);
+    // Headless subcommands (export, stats, simulate, import) skip the GUI entirely
+    if (CommandLine::isCommand(argc, argv))
+        return CommandLine::run(argc, argv);
 
-    }
-    else
-        QMessageBox::critical(nullptr, QObject::tr("database is not open"),
-                              QObject::tr("connection failed.\n"
-                                          "Click Cancel to exit."), QMessageBox::Cancel);
+    StartupTimeline::instance().start();
+    QApplication a(argc, argv);
 
+    // The window comes up at once; the database and the gates connect behind it
+    MainWindow w;
+    w.show();
 
+    // Logs every freeze of the event loop with the GUI thread's stack, from
+    // the moment the loop runs
+    StallDetector stallDetector;
+    QTimer::singleShot(0, [&stallDetector]() {
+        StartupTimeline::instance().mark("first-interaction");
+        stallDetector.start();
+    });
 
-    return a.exec();
+    int result = a.exec();
+#ifdef PROBALL_TRACING
+    Trace::writeFromEnvironment();
+#endif
+    return result;
 }
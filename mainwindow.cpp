@@ -23,155 +23,175 @@
 #include <QCalendarWidget>
 #include <QElapsedTimer>
 #include <QGraphicsSceneHoverEvent>
+#include <QSpinBox>
+#include <QMenuBar>
+#include <QMenu>
 #include "hologrambar.h"
+#include "queryprofiler.h"
+#include "attendancestats.h"
+#include "attendancecube.h"
+#include "matchfilterproxy.h"
+#include "reportwriter.h"
+#include "reportjobs.h"
+#include "reportcache.h"
+#include "reportbatch.h"
+#include "matchsimulation.h"
+#include "statsdashboard.h"
+#include "startuptimeline.h"
+#include "trace.h"
+#include <QPdfWriter>
+#include <QPicture>
+#include <QSvgGenerator>
+#include <QProgressBar>
+#include <QApplication>
+#include <QFile>
+#include <QtMath>
+#include <QDockWidget>
+#include <QDateEdit>
+#include <QGroupBox>
+#include <QListWidget>
+#include <QFormLayout>
+#include <QComboBox>
+#include <QTreeWidget>
+#include <QFutureWatcher>
+#include <QtConcurrent>
 
-#include <QSerialPort>
-#include <QSerialPortInfo>
 
 
 
 // Add these implementations to your mainwindow.cpp file
 void MainWindow::setupArduinoConnection()
 {
-    arduino = new QSerialPort(this);
-
-    // List all available ports for debugging
-    qDebug() << "Available serial ports:";
-    const auto infos = QSerialPortInfo::availablePorts();
-    for (const QSerialPortInfo &info : infos) {
-        qDebug() << "Port:" << info.portName()
-        << "Description:" << info.description()
-        << "Manufacturer:" << info.manufacturer();
-    }
-
-    // Try to find Arduino
-    bool arduinoFound = false;
-    for (const QSerialPortInfo &info : infos) {
-        // Look for Arduino with broader criteria
-        if (info.description().contains("Arduino", Qt::CaseInsensitive) ||
-            info.manufacturer().contains("Arduino", Qt::CaseInsensitive) ||
-            info.description().contains("CH340", Qt::CaseInsensitive) ||  // Common Arduino clone chip
-            info.description().contains("USB Serial", Qt::CaseInsensitive)) {  // Generic descriptor often used
-
-            arduino->setPort(info);
-            arduinoFound = true;
-            qDebug() << "Found potential Arduino:" << info.portName();
-            break;
-        }
-    }
-
-    if (!arduinoFound) {
-        qDebug() << "Arduino not found automatically. Please select port manually.";
-        // You could add UI here to let user select from available ports
-
-        // For now, use the first available port as fallback if any exist
-        if (!infos.isEmpty()) {
-            arduino->setPort(infos.first());
-            qDebug() << "Using first available port as fallback:" << infos.first().portName();
-        } else {
-            qDebug() << "No serial ports available!";
-            return;
-        }
-    }
-
-    // Configure the serial port
-    arduino->setBaudRate(QSerialPort::Baud9600);
-    arduino->setDataBits(QSerialPort::Data8);
-    arduino->setParity(QSerialPort::NoParity);
-    arduino->setStopBits(QSerialPort::OneStop);
-    arduino->setFlowControl(QSerialPort::NoFlowControl);
-
-    // Open the serial port for read and write (not just write only)
-    if (!arduino->open(QIODevice::ReadWrite)) {
-        qDebug() << "Failed to open Arduino serial port! Error:" << arduino->errorString();
-    } else {
-        qDebug() << "Connected to Arduino on" << arduino->portName();
-    }
+    // Gate discovery, handshakes and writes all happen off the GUI thread
+    gateManager = new GateManager(this);
+    connect(gateManager, &GateManager::gatesChanged, this, [this]() {
+        ui->statusbar->showMessage(tr("%n gate controller(s) connected.", "", gateManager->connectedGates()), 3000);
+    });
+    connect(gateManager, &GateManager::capacityConfirmed, this, [this](const QString &gateId, int capacity, int roundTripMs) {
+        ui->statusbar->showMessage(tr("Gate %1 confirmed capacity %2 (%3 ms).").arg(gateId).arg(capacity).arg(roundTripMs), 2000);
+    });
+    StartupTimeline::instance().begin("gates.scan");
+    connect(gateManager, &GateManager::scanCompleted, this, []() {
+        StartupTimeline::instance().end("gates.scan");
+    }, Qt::SingleShotConnection);
+    gateManager->start();
+
+    // Live occupancy under the SPECTATEURS field; refreshed a few times per second
+    occupancyTracker = new OccupancyTracker(gateManager, this);
+    occupancyLabel = new QLabel(ui->centralwidget);
+    occupancyLabel->setGeometry(38, 380, 252, 34);
+    occupancyLabel->setWordWrap(true);
+    connect(occupancyTracker, &OccupancyTracker::updated, this, &MainWindow::updateOccupancyLabel);
+    updateOccupancyLabel();
 }
 
-void MainWindow::sendStadiumCapacityToArduino(int spectatorCount)
+void MainWindow::updateOccupancyLabel()
 {
-    if (!arduino) {
-        qDebug() << "Arduino object not created!";
+    const QList<OccupancyTracker::GateStats> gates = occupancyTracker->gateStats();
+    if (gates.isEmpty()) {
+        occupancyLabel->setText(tr("No turnstile data"));
+        occupancyLabel->setToolTip(QString());
         return;
     }
 
-    if (!arduino->isOpen()) {
-        qDebug() << "Arduino is not connected! Attempting to reconnect...";
-        if (!arduino->open(QIODevice::ReadWrite)) {
-            qDebug() << "Failed to reconnect to Arduino:" << arduino->errorString();
-            return;
-        }
+    QString text = occupancyTracker->capacity() >= 0
+                       ? tr("Inside: %1 / %2").arg(occupancyTracker->occupancy()).arg(occupancyTracker->capacity())
+                       : tr("Inside: %1").arg(occupancyTracker->occupancy());
+    text += tr(" - %1/min").arg(occupancyTracker->entriesPerMinute());
+    const int seconds = occupancyTracker->secondsToCapacity();
+    if (seconds == 0)
+        text += tr("\nAt capacity");
+    else if (seconds > 0)
+        text += tr("\nFull in %1 min").arg((seconds + 59) / 60);
+    occupancyLabel->setText(text);
+
+    // Per-gate breakdown on hover
+    QStringList lines;
+    for (const OccupancyTracker::GateStats &gate : gates) {
+        lines << tr("%1: %2 in, %3 out, %4/min").arg(gate.gateId).arg(gate.entries).arg(gate.exits)
+                     .arg(gate.entriesPerMinute);
     }
-
-    // Send capacity command to Arduino
-    // Format: C{capacity}\n
-    QString command = QString("C%1\n").arg(spectatorCount);
-    qint64 bytesWritten = arduino->write(command.toUtf8());
-
-    if (bytesWritten == -1) {
-        qDebug() << "Failed to send data to Arduino:" << arduino->errorString();
-    } else if (bytesWritten != command.length()) {
-        qDebug() << "Warning: Not all data was sent to Arduino!";
-    } else {
-        qDebug() << "Sent stadium capacity to Arduino:" << spectatorCount << "spectators";
+    if (occupancyTracker->lostFrames() > 0 || occupancyTracker->droppedEvents() > 0) {
+        lines << tr("Lost telemetry: %1 frames on the wire, %2 in the buffers")
+                     .arg(occupancyTracker->lostFrames()).arg(occupancyTracker->droppedEvents());
     }
+    occupancyLabel->setToolTip(lines.join('\n'));
+}
 
-    // Make sure data is sent immediately
-    arduino->flush();
+void MainWindow::sendStadiumCapacityToArduino(int spectatorCount)
+{
+    // Returns immediately; the capacity is split across the connected gates
+    gateManager->setCapacity(spectatorCount);
+    occupancyTracker->setCapacity(spectatorCount);
 }
 void MainWindow::resetStadiumBarrier()
 {
-    if (!arduino || !arduino->isOpen()) {
-        qDebug() << "Arduino is not connected!";
-        return;
-    }
-
-    // Send reset command to Arduino
-    arduino->write("R\n");
-    qDebug() << "Reset stadium barrier";
+    gateManager->reset();
+    occupancyTracker->reset();
 }
 
 // Modify your MainWindow constructor:
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
     ui(new Ui::MainWindow),
+    model(nullptr),
     currentId(-1),
+    attendanceStats(nullptr),
+    matchStore(nullptr),
+    analyticsAction(nullptr),
+    batchReportsAction(nullptr),
     calendar(nullptr),
-    arduino(nullptr)  // Initialize arduino pointer
+    gateManager(nullptr),
+    occupancyTracker(nullptr),
+    occupancyLabel(nullptr)
 {
+    StartupPhase windowPhase("window");
     ui->setupUi(this);
-    // Create a connection object
+    // Create a connection object; it is opened in the background by startDatabase()
     connection = new Connection();
-    connect(ui->lineEdit_SearchTypeMatch, &QLineEdit::textChanged, this, &MainWindow::filterByTypeMatch);
+    connect(ui->lineEdit_SearchTypeMatch, &QLineEdit::textChanged, this, &MainWindow::searchMatches);
 
-    // Initialize the database connection
-    if (!connection->createconnect()) {
-        QMessageBox::critical(this, "Database Error", "Cannot establish database connection!");
-        return;
-    }
+    // Create a proxy model for sorting; the SQL model is attached once the database is up
+    proxyModel = new MatchFilterProxy(this);
 
-    // Set up the model for the table view
-    model = new QSqlTableModel(this, connection->getConnection());
-    model->setTable("MATCHES"); // Use your MATCHES table
-    // Set edit strategy
-    model->setEditStrategy(QSqlTableModel::OnManualSubmit);
+    // Connect the table view to the proxy model instead of directly to the model
+    ui->tableView->setModel(proxyModel);
 
-    // Set column headers - adjusted to match MATCHES table structure including new columns
-    model->setHeaderData(0, Qt::Horizontal, "ID");
-    model->setHeaderData(1, Qt::Horizontal, "Date");
-    model->setHeaderData(2, Qt::Horizontal, "Lieu");
-    model->setHeaderData(3, Qt::Horizontal, "Status");
-    model->setHeaderData(4, Qt::Horizontal, "Score");
-    model->setHeaderData(5, Qt::Horizontal, "Type");
-    model->setHeaderData(6, Qt::Horizontal, "Spectateurs");
+    const QString connectionName = QLatin1String(QSqlDatabase::defaultConnection);
 
-    // Create a proxy model for sorting
-    proxyModel = new QSortFilterProxyModel(this);
-    proxyModel->setSourceModel(model);
+    // Cached copy of MATCHES used by the analytics
+    matchStore = new MatchStore(connectionName, this);
 
-    // Connect the table view to the proxy model instead of directly to the model
-    ui->tableView->setModel(proxyModel);
+    // In-memory attendance aggregates, kept in step with the cached matches
+    attendanceStats = new AttendanceAggregates(matchStore, this);
+
+    // Column sorts use typed keys extracted from the cached matches
+    proxyModel->setMatchStore(matchStore);
+
+    // Keep the search index in step with the cached matches
+    searchIndex.build(matchStore->matches());
+    connect(matchStore, &MatchStore::reloaded, this, [this]() {
+        searchIndex.build(matchStore->matches());
+        searchMatches();
+    });
+    connect(matchStore, &MatchStore::matchInserted, this, [this](const Match &match) {
+        searchIndex.addMatch(match);
+        if (proxyModel->isSearchActive())
+            searchMatches();
+    });
+    connect(matchStore, &MatchStore::matchUpdated, this, [this](const Match &before, const Match &after) {
+        searchIndex.updateMatch(before, after);
+        if (proxyModel->isSearchActive())
+            searchMatches();
+    });
+    connect(matchStore, &MatchStore::matchRemoved, this, [this](const Match &match) {
+        searchIndex.removeMatch(match);
+        if (proxyModel->isSearchActive())
+            searchMatches();
+    });
+
+    // Multi-criteria filter panel
+    setupFilterPanel();
 
     // Enable sorting on the table view
     ui->tableView->setSortingEnabled(true);
@@ -197,10 +217,202 @@ MainWindow::MainWindow(QWidget *parent) :
     // Setup Arduino connection
     setupArduinoConnection();
 
+    // Background report jobs: progress and cancel live in the status bar
+    reportJobs = new ReportJobManager(this);
+    jobProgressBar = new QProgressBar(this);
+    jobProgressBar->setRange(0, 100);
+    jobProgressBar->setMaximumWidth(180);
+    jobProgressBar->setFormat("Export %p%");
+    jobProgressBar->hide();
+    jobCancelButton = new QPushButton("Cancel Export", this);
+    jobCancelButton->hide();
+    ui->statusbar->addPermanentWidget(jobProgressBar);
+    ui->statusbar->addPermanentWidget(jobCancelButton);
+    connect(reportJobs, &ReportJobManager::progressChanged, jobProgressBar, &QProgressBar::setValue);
+    connect(jobCancelButton, &QPushButton::clicked, reportJobs, &ReportJobManager::cancelAll);
+    connect(reportJobs, &ReportJobManager::jobStarted, this, [this](const QString &title) {
+        jobProgressBar->show();
+        jobCancelButton->show();
+        ui->statusbar->showMessage(tr("%1 running in the background...").arg(title), 3000);
+    });
+    connect(reportJobs, &ReportJobManager::jobFinished, this, &MainWindow::onReportJobFinished);
+
     // Add a reset button to the UI for the Arduino barrier
     QPushButton *resetButton = new QPushButton("Reset Stadium Barrier", this);
     ui->statusbar->addPermanentWidget(resetButton);
     connect(resetButton, &QPushButton::clicked, this, &MainWindow::resetStadiumBarrier);
+
+    // Tools menu for diagnostics
+    QMenu *toolsMenu = ui->menubar->addMenu("Tools");
+    toolsMenu->addAction(filterDock->toggleViewAction());
+    analyticsAction = toolsMenu->addAction("Attendance Analytics...", this, &MainWindow::showAttendanceAnalyticsDialog);
+    batchReportsAction = toolsMenu->addAction("Batch Reports...", this, &MainWindow::showBatchReportDialog);
+    toolsMenu->addAction("Clear Report Cache", this, [this]() {
+        ReportCache::instance().clear();
+        ui->statusbar->showMessage(tr("Report cache cleared."), 3000);
+    });
+    toolsMenu->addAction("Query Diagnostics...", this, &MainWindow::showQueryDiagnosticsDialog);
+#ifdef PROBALL_TRACING
+    toolsMenu->addAction("Save Trace...", this, [this]() {
+        QString fileName = QFileDialog::getSaveFileName(this, "Save Trace", "proball-trace.json", "Trace Files (*.json)");
+        if (fileName.isEmpty())
+            return;
+        QString error;
+        if (!Trace::writeJson(fileName, &error)) {
+            qDebug() << "Trace export failed:" << error;
+            QMessageBox::critical(this, "Error", "Failed to save the trace: " + error);
+            return;
+        }
+        ui->statusbar->showMessage(tr("Trace saved to %1").arg(fileName), 3000);
+    });
+#endif
+
+    // Database connect and the initial load run while the window is already up
+    setDatabaseWidgetsEnabled(false);
+    startDatabase();
+}
+
+namespace {
+
+// What the startup loader hands back to the GUI thread
+struct StartupLoad
+{
+    bool connected = false;
+    bool loaded = false;
+    QString error;
+    QVector<Match> matches;
+};
+
+StartupLoad connectAndLoad(QThread *guiThread)
+{
+    StartupLoad result;
+#if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
+    // Open the application's own connection here, then hand it to the GUI thread
+    const QString name = QLatin1String(QSqlDatabase::defaultConnection);
+#else
+    // Connections cannot change threads before Qt 6.8; load through a private one
+    const QString name = "proball_startup_loader";
+    Q_UNUSED(guiThread);
+#endif
+
+    {
+        StartupPhase phase("db.connect");
+        Connection connection;
+        result.connected = connection.createconnect(name);
+    }
+
+    {
+        QSqlDatabase db = QSqlDatabase::database(name, false);
+        if (!result.connected) {
+            result.error = db.lastError().text();
+        } else {
+            StartupPhase phase("db.load");
+            result.loaded = MatchStore::loadAll(db, result.matches, &result.error);
+        }
+#if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
+        db.moveToThread(guiThread);
+#else
+        db.close();
+#endif
+    }
+#if QT_VERSION < QT_VERSION_CHECK(6, 8, 0)
+    QSqlDatabase::removeDatabase(name);
+#endif
+    return result;
+}
+
+} // namespace
+
+void MainWindow::startDatabase()
+{
+    ui->statusbar->showMessage(tr("Connecting to the database..."));
+
+    QFutureWatcher<StartupLoad> *watcher = new QFutureWatcher<StartupLoad>(this);
+    connect(watcher, &QFutureWatcher<StartupLoad>::finished, this, [this, watcher]() {
+        const StartupLoad load = watcher->result();
+        watcher->deleteLater();
+
+        if (!load.connected || !connectGuiThread()) {
+            ui->statusbar->showMessage(tr("Database connection failed."));
+            QMessageBox::critical(this, "Database Error", "Cannot establish database connection!");
+            return;
+        }
+
+        {
+            StartupPhase phase("ui.fill");
+            if (load.loaded)
+                matchStore->setMatches(load.matches);
+            else
+                matchStore->load();
+            onDatabaseReady();
+        }
+        // After the phase above has ended, so that it is checked against its budget
+        StartupTimeline::instance().mark("ready");
+        StartupTimeline::instance().finish();
+    });
+    watcher->setFuture(QtConcurrent::run(connectAndLoad, thread()));
+}
+
+bool MainWindow::connectGuiThread()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
+    // The loader's connection has been handed over; this only finds it
+    return connection->createconnect();
+#else
+    // Before Qt 6.8 a connection cannot change threads, so the GUI thread
+    // must open its own, and that blocks it for one ODBC connect. It is done
+    // here, once the loader has finished, rather than racing with the first
+    // paint: the window stays responsive through the loader's connect and
+    // load, but this build gains nothing on the connect itself.
+    ui->statusbar->showMessage(tr("Opening the table..."));
+    ui->statusbar->repaint();
+    StartupPhase phase("db.connect.gui");
+    return connection->createconnect();
+#endif
+}
+
+void MainWindow::onDatabaseReady()
+{
+    // Set up the model for the table view
+    model = new QSqlTableModel(this, connection->getConnection());
+    model->setTable("MATCHES"); // Use your MATCHES table
+    // Set edit strategy
+    model->setEditStrategy(QSqlTableModel::OnManualSubmit);
+
+    // Set column headers - adjusted to match MATCHES table structure including new columns
+    model->setHeaderData(0, Qt::Horizontal, "ID");
+    model->setHeaderData(1, Qt::Horizontal, "Date");
+    model->setHeaderData(2, Qt::Horizontal, "Lieu");
+    model->setHeaderData(3, Qt::Horizontal, "Status");
+    model->setHeaderData(4, Qt::Horizontal, "Score");
+    model->setHeaderData(5, Qt::Horizontal, "Type");
+    model->setHeaderData(6, Qt::Horizontal, "Spectateurs");
+    proxyModel->setSourceModel(model);
+
+    // Fill the table right away instead of waiting for Read
+    {
+        StartupPhase phase("model.select");
+        refreshTable();
+    }
+
+    setDatabaseWidgetsEnabled(true);
+    ui->statusbar->showMessage(tr("%1 matches loaded.").arg(matchStore->size()), 3000);
+}
+
+void MainWindow::setDatabaseWidgetsEnabled(bool enabled)
+{
+    // Everything that reads or writes through the SQL model
+    const QList<QWidget *> widgets = {
+        ui->pushButton_Create, ui->pushButton_Read, ui->pushButton_Update, ui->pushButton_Delete,
+        ui->pushButton_SortDateAsc, ui->pushButton_SortDateDesc, ui->pushButton_ExportPDF,
+        ui->pushButton_Simulate, ui->pushButton_Calendar, ui->pushButton_MatchStats, ui->tableView
+    };
+    for (QWidget *widget : widgets)
+        widget->setEnabled(enabled);
+
+    // Tools that work on the match store snapshot
+    analyticsAction->setEnabled(enabled);
+    batchReportsAction->setEnabled(enabled);
 }
 
 // Add this to your destructor
@@ -210,13 +422,8 @@ MainWindow::~MainWindow()
         delete calendar;
     }
 
-    // Close and delete Arduino connection
-    if (arduino) {
-        if (arduino->isOpen()) {
-            arduino->close();
-        }
-        delete arduino;
-    }
+    // Stops every gate thread; the ports are closed there
+    delete gateManager;
 
     delete proxyModel;
     delete model;
@@ -226,26 +433,210 @@ MainWindow::~MainWindow()
 
 void MainWindow::refreshTable()
 {
-    model->select();
+    PB_TRACE_SCOPE_DETAIL("sql.exec", QString("MATCHES model select"));
+    // QSqlTableModel runs its own SELECT, so time it here
+    QElapsedTimer timer;
+    timer.start();
+    bool ok = model->select();
+    qint64 execMicros = timer.nsecsElapsed() / 1000;
+    QueryProfiler::instance().record("MATCHES model select", model->query().lastQuery(),
+                                     0, execMicros, 0, model->rowCount(), 0, ok);
 
     if (model->lastError().isValid()) {
         QMessageBox::warning(this, "Database Error",
                              "Failed to load data: " + model->lastError().text());
     }
 }
-void MainWindow::filterByTypeMatch()
+void MainWindow::searchMatches()
 {
-    QString filterText = ui->lineEdit_SearchTypeMatch->text();
-    if (filterText.isEmpty()) {
-        proxyModel->setFilterFixedString(""); // Clears the filter
+    QString searchText = ui->lineEdit_SearchTypeMatch->text().trimmed();
+    if (searchText.isEmpty()) {
+        proxyModel->clearSearch(); // Clears the filter
+        return;
+    }
 
-    } else {
-        // Assuming the "TYPEMATCH" column is column index 5
-        proxyModel->setFilterKeyColumn(5);
-        proxyModel->setFilterCaseSensitivity(Qt::CaseInsensitive);
-        proxyModel->setFilterFixedString(filterText);
+    // Look up venue, type and status in the trigram index
+    QHash<int, double> scores;
+    const QVector<TrigramIndex::Hit> hits = searchIndex.search(searchText);
+    scores.reserve(hits.size());
+    for (const TrigramIndex::Hit &hit : hits)
+        scores.insert(hit.id, hit.score);
+
+    proxyModel->setSearchResults(scores);
+    proxyModel->sortByRank();
+}
+void MainWindow::setupFilterPanel()
+{
+    filterDock = new QDockWidget("Filters", this);
+    filterDock->setObjectName("filterDock");
+    QWidget *panel = new QWidget(filterDock);
+    QVBoxLayout *layout = new QVBoxLayout(panel);
+
+    // Date range
+    filterDateGroup = new QGroupBox("Date", panel);
+    filterDateGroup->setCheckable(true);
+    filterDateGroup->setChecked(false);
+    QFormLayout *dateLayout = new QFormLayout(filterDateGroup);
+    filterFromEdit = new QDateEdit(QDate::currentDate().addYears(-1), filterDateGroup);
+    filterToEdit = new QDateEdit(QDate::currentDate().addYears(1), filterDateGroup);
+    filterFromEdit->setCalendarPopup(true);
+    filterToEdit->setCalendarPopup(true);
+    filterFromEdit->setDisplayFormat("yyyy-MM-dd");
+    filterToEdit->setDisplayFormat("yyyy-MM-dd");
+    dateLayout->addRow("From", filterFromEdit);
+    dateLayout->addRow("To", filterToEdit);
+    layout->addWidget(filterDateGroup);
+
+    // Spectator range
+    filterSpectateursGroup = new QGroupBox("Spectateurs", panel);
+    filterSpectateursGroup->setCheckable(true);
+    filterSpectateursGroup->setChecked(false);
+    QFormLayout *spectateursLayout = new QFormLayout(filterSpectateursGroup);
+    filterMinSpin = new QSpinBox(filterSpectateursGroup);
+    filterMaxSpin = new QSpinBox(filterSpectateursGroup);
+    filterMinSpin->setRange(0, 1000000);
+    filterMaxSpin->setRange(0, 1000000);
+    filterMaxSpin->setValue(100000);
+    spectateursLayout->addRow("Min", filterMinSpin);
+    spectateursLayout->addRow("Max", filterMaxSpin);
+    layout->addWidget(filterSpectateursGroup);
+
+    // Categorical fields, nothing checked means any value
+    auto addList = [panel, layout](const QString &title) {
+        QGroupBox *group = new QGroupBox(title, panel);
+        QVBoxLayout *groupLayout = new QVBoxLayout(group);
+        QListWidget *list = new QListWidget(group);
+        list->setMaximumHeight(120);
+        groupLayout->addWidget(list);
+        layout->addWidget(group);
+        return list;
+    };
+    filterStatusList = addList("Status");
+    filterTypeList = addList("Type");
+    filterVenueList = addList("Lieu");
+
+    QPushButton *clearButton = new QPushButton("Clear Filters", panel);
+    layout->addWidget(clearButton);
+    layout->addStretch();
+
+    filterDock->setWidget(panel);
+    addDockWidget(Qt::RightDockWidgetArea, filterDock);
+    filterDock->hide();
+
+    // Debounce so typing in a spin box doesn't refilter on every key
+    filterDebounce = new QTimer(this);
+    filterDebounce->setSingleShot(true);
+    filterDebounce->setInterval(120);
+    connect(filterDebounce, &QTimer::timeout, this, &MainWindow::applyFilters);
+
+    auto schedule = [this]() { filterDebounce->start(); };
+    connect(filterDateGroup, &QGroupBox::toggled, this, schedule);
+    connect(filterFromEdit, &QDateEdit::dateChanged, this, schedule);
+    connect(filterToEdit, &QDateEdit::dateChanged, this, schedule);
+    connect(filterSpectateursGroup, &QGroupBox::toggled, this, schedule);
+    connect(filterMinSpin, &QSpinBox::valueChanged, this, schedule);
+    connect(filterMaxSpin, &QSpinBox::valueChanged, this, schedule);
+    connect(filterStatusList, &QListWidget::itemChanged, this, schedule);
+    connect(filterTypeList, &QListWidget::itemChanged, this, schedule);
+    connect(filterVenueList, &QListWidget::itemChanged, this, schedule);
+
+    connect(clearButton, &QPushButton::clicked, this, [this]() {
+        filterDateGroup->setChecked(false);
+        filterSpectateursGroup->setChecked(false);
+        for (QListWidget *list : {filterStatusList, filterTypeList, filterVenueList}) {
+            QSignalBlocker blocker(list);
+            for (int i = 0; i < list->count(); ++i)
+                list->item(i)->setCheckState(Qt::Unchecked);
+        }
+        filterDebounce->start();
+    });
+
+    // New values may appear after CRUD; re-apply the active criteria too.
+    // A single-row change only touches that row, unless the engine is behind
+    // the store anyway (then populateFilterLists rebuilds it)
+    connect(matchStore, &MatchStore::reloaded, this, &MainWindow::populateFilterLists);
+    connect(matchStore, &MatchStore::matchInserted, this, [this](const Match &match) {
+        if (filterEngine.version() + 1 == matchStore->version())
+            filterEngine.insertMatch(match, matchStore->version());
+        populateFilterLists();
+    });
+    connect(matchStore, &MatchStore::matchUpdated, this, [this](const Match &, const Match &after) {
+        if (filterEngine.version() + 1 == matchStore->version())
+            filterEngine.updateMatch(after, matchStore->version());
+        populateFilterLists();
+    });
+    connect(matchStore, &MatchStore::matchRemoved, this, [this](const Match &match) {
+        if (filterEngine.version() + 1 == matchStore->version())
+            filterEngine.removeMatch(match.id, matchStore->version());
+        populateFilterLists();
+    });
+
+    populateFilterLists();
+}
+
+void MainWindow::populateFilterLists()
+{
+    if (filterEngine.version() != matchStore->version())
+        filterEngine.setMatches(matchStore->matches(), matchStore->version());
+
+    auto fill = [](QListWidget *list, const QStringList &values) {
+        QSet<QString> checked;
+        for (int i = 0; i < list->count(); ++i) {
+            if (list->item(i)->checkState() == Qt::Checked)
+                checked.insert(list->item(i)->text());
+        }
+
+        QSignalBlocker blocker(list);
+        list->clear();
+        for (const QString &value : values) {
+            QListWidgetItem *item = new QListWidgetItem(value, list);
+            item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+            item->setCheckState(checked.contains(value) ? Qt::Checked : Qt::Unchecked);
+        }
+    };
+    fill(filterStatusList, filterEngine.statuses());
+    fill(filterTypeList, filterEngine.types());
+    fill(filterVenueList, filterEngine.venues());
+
+    filterDebounce->start();
+}
+
+void MainWindow::applyFilters()
+{
+    auto checkedValues = [](QListWidget *list) {
+        QSet<QString> values;
+        for (int i = 0; i < list->count(); ++i) {
+            if (list->item(i)->checkState() == Qt::Checked)
+                values.insert(list->item(i)->text());
+        }
+        return values;
+    };
+
+    MatchFilterCriteria criteria;
+    if (filterDateGroup->isChecked()) {
+        criteria.from = filterFromEdit->date();
+        criteria.to = filterToEdit->date();
+    }
+    if (filterSpectateursGroup->isChecked()) {
+        criteria.minSpectateurs = filterMinSpin->value();
+        criteria.maxSpectateurs = filterMaxSpin->value();
     }
+    criteria.statuses = checkedValues(filterStatusList);
+    criteria.types = checkedValues(filterTypeList);
+    criteria.venues = checkedValues(filterVenueList);
+
+    if (criteria.isEmpty()) {
+        proxyModel->clearCriteriaFilter();
+        return;
+    }
+
+    if (filterEngine.version() != matchStore->version())
+        filterEngine.setMatches(matchStore->matches(), matchStore->version());
+
+    const QVector<int> rows = filterEngine.evaluate(criteria);
+    proxyModel->setCriteriaFilter(filterEngine.acceptedIds(rows));
 }
+
 void MainWindow::on_pushButton_Simulate_clicked()
 {
     QModelIndex currentIndex = ui->tableView->currentIndex();
@@ -260,14 +651,9 @@ void MainWindow::on_pushButton_Simulate_clicked()
     QString scoreString = model->data(model->index(sourceRow, scoreColumn)).toString();
 
     // Split the score string "2-2" into home and away scores
-    QStringList scores = scoreString.split("-");
     int homeScore = 0;
     int awayScore = 0;
-
-    if (scores.size() == 2) {
-        homeScore = scores[0].toInt();
-        awayScore = scores[1].toInt();
-    }
+    MatchSimulation::parseScore(scoreString, &homeScore, &awayScore);
 
     qDebug() << "Home Score:" << homeScore << "Away Score:" << awayScore;
 
@@ -360,39 +746,9 @@ void MainWindow::showMatchSimulation(int expectedTeamAScore, int expectedTeamBSc
     timerDisplay->setFont(QFont("Arial", 14, QFont::Bold));
     simulationScene->addItem(timerDisplay);
 
-    // Plan goal times for team A
-    teamAScoreTimes.clear();
-    for (int i = 0; i < targetTeamAScore; i++) {
-        // Distribute goals throughout the match, some in first half, some in second
-        int goalTime;
-        if (i < targetTeamAScore / 2) {
-            // First half goals (1-45 seconds)
-            goalTime = QRandomGenerator::global()->bounded(5, 44);
-        } else {
-            // Second half goals (46-90 seconds)
-            goalTime = QRandomGenerator::global()->bounded(46, 89);
-        }
-        teamAScoreTimes.append(goalTime);
-    }
-    // Sort goal times in ascending order
-    std::sort(teamAScoreTimes.begin(), teamAScoreTimes.end());
-
-    // Plan goal times for team B
-    teamBScoreTimes.clear();
-    for (int i = 0; i < targetTeamBScore; i++) {
-        // Distribute goals throughout the match, some in first half, some in second
-        int goalTime;
-        if (i < targetTeamBScore / 2) {
-            // First half goals (1-45 seconds)
-            goalTime = QRandomGenerator::global()->bounded(5, 44);
-        } else {
-            // Second half goals (46-90 seconds)
-            goalTime = QRandomGenerator::global()->bounded(46, 89);
-        }
-        teamBScoreTimes.append(goalTime);
-    }
-    // Sort goal times in ascending order
-    std::sort(teamBScoreTimes.begin(), teamBScoreTimes.end());
+    // Plan goal times for both teams
+    teamAScoreTimes = MatchSimulation::planGoalTimes(targetTeamAScore);
+    teamBScoreTimes = MatchSimulation::planGoalTimes(targetTeamBScore);
 
     // Create players for team A (red)
     for (int i = 0; i < 11; i++) {
@@ -477,29 +833,8 @@ void MainWindow::showMatchSimulation(int expectedTeamAScore, int expectedTeamBSc
         timerDisplay->setPlainText(QString("Time: %1'").arg(elapsedSeconds));
 
         // Replan goal times (keeping the same number of goals)
-        teamAScoreTimes.clear();
-        for (int i = 0; i < targetTeamAScore; i++) {
-            int goalTime;
-            if (i < targetTeamAScore / 2) {
-                goalTime = QRandomGenerator::global()->bounded(5, 44);
-            } else {
-                goalTime = QRandomGenerator::global()->bounded(46, 89);
-            }
-            teamAScoreTimes.append(goalTime);
-        }
-        std::sort(teamAScoreTimes.begin(), teamAScoreTimes.end());
-
-        teamBScoreTimes.clear();
-        for (int i = 0; i < targetTeamBScore; i++) {
-            int goalTime;
-            if (i < targetTeamBScore / 2) {
-                goalTime = QRandomGenerator::global()->bounded(5, 44);
-            } else {
-                goalTime = QRandomGenerator::global()->bounded(46, 89);
-            }
-            teamBScoreTimes.append(goalTime);
-        }
-        std::sort(teamBScoreTimes.begin(), teamBScoreTimes.end());
+        teamAScoreTimes = MatchSimulation::planGoalTimes(targetTeamAScore);
+        teamBScoreTimes = MatchSimulation::planGoalTimes(targetTeamBScore);
 
         // Reset player positions
         for (int i = 0; i < teamAPlayers.size(); i++) {
@@ -542,6 +877,7 @@ void MainWindow::showMatchSimulation(int expectedTeamAScore, int expectedTeamBSc
 // Replace your existing updateSimulation() method with this one
 void MainWindow::updateSimulation()
 {
+    PB_TRACE_SCOPE("simulation.tick");
     simulationStep++;
 
     // Handle match timer - one second of real time equals one second of match time
@@ -1074,6 +1410,7 @@ void MainWindow::on_pushButton_Read_clicked()
 {
     // Refresh the table to show all records
     refreshTable();
+    matchStore->load();
     clearInputFields();
 }
 
@@ -1094,7 +1431,7 @@ void MainWindow::on_pushButton_Create_clicked()
     }
 
     // Using direct SQL to insert the record
-    QSqlQuery query(connection->getConnection());
+    ProfiledQuery query("MATCHES insert", connection->getConnection());
     query.prepare("INSERT INTO MATCHES (DATEMATCH, LIEU, STATUS, SCORE, TYPEMATCH, SPECTATEURS) VALUES (?, ?, ?, ?, ?, ?)");
 
     // Convert the date string to QDateTime and then to the database format
@@ -1107,6 +1444,7 @@ void MainWindow::on_pushButton_Create_clicked()
     query.bindValue(5, spectateurs);
 
     if (query.exec()) {
+        matchStore->syncNewMatches();
         QMessageBox::information(this, "Success", "Match created successfully");
         refreshTable(); // Refresh to show the new data
         clearInputFields();
@@ -1150,7 +1488,7 @@ void MainWindow::on_pushButton_Update_clicked()
     }
 
     // Update the record using the original ID
-    QSqlQuery query(connection->getConnection());
+    ProfiledQuery query("MATCHES update", connection->getConnection());
     query.prepare("UPDATE MATCHES SET DATEMATCH=?, LIEU=?, STATUS=?, SCORE=?, TYPEMATCH=?, SPECTATEURS=? WHERE IDMATCH=?");
 
     // Convert the date string to QDateTime and then to the database format
@@ -1173,6 +1511,7 @@ void MainWindow::on_pushButton_Update_clicked()
     query.bindValue(6, id);
 
     if (query.exec()) {
+        matchStore->refreshMatch(id);
         QMessageBox::information(this, "Success", "Match updated successfully");
         refreshTable(); // Refresh to show the updated data
         clearInputFields();
@@ -1208,11 +1547,12 @@ void MainWindow::on_pushButton_Delete_clicked()
 
     if (reply == QMessageBox::Yes) {
         // Using direct SQL to delete the record
-        QSqlQuery query(connection->getConnection());
+        ProfiledQuery query("MATCHES delete", connection->getConnection());
         query.prepare("DELETE FROM MATCHES WHERE IDMATCH=?");
         query.bindValue(0, id);
 
         if (query.exec()) {
+            matchStore->removeMatch(id);
             QMessageBox::information(this, "Success", "Match deleted successfully");
             refreshTable(); // Refresh to show the data after deletion
             clearInputFields();
@@ -1290,6 +1630,7 @@ void MainWindow::onSortIndicatorChanged(int logicalIndex, Qt::SortOrder order)
 
 void MainWindow::exportToPdf()
 {
+    PB_TRACE_SCOPE("export.matches-pdf");
     // Ask user for the file location to save PDF
     QString fileName = QFileDialog::getSaveFileName(this, tr("Export PDF"),
                                                     QString(), tr("PDF Files (*.pdf)"));
@@ -1300,77 +1641,35 @@ void MainWindow::exportToPdf()
     if (!fileName.endsWith(".pdf", Qt::CaseInsensitive))
         fileName += ".pdf";
 
-    // Create a printer object
-    QPrinter printer(QPrinter::HighResolution);
-    printer.setOutputFormat(QPrinter::PdfFormat);
-    printer.setOutputFileName(fileName);
-    printer.setPageOrientation(QPageLayout::Landscape);
-
-    // Create a text document to format our table
-    QTextDocument doc;
-    QTextCursor cursor(&doc);
-
-    // Add a title
-    QTextCharFormat titleFormat;
-    titleFormat.setFontPointSize(16);
-    titleFormat.setFontWeight(QFont::Bold);
-    cursor.insertText("Matches Report\n\n", titleFormat);
-
-    // Create a table with rows and columns matching our data model
-    int rowCount = proxyModel->rowCount();
-    int columnCount = proxyModel->columnCount();
-
-    QTextTable *table = cursor.insertTable(rowCount + 1, columnCount);
-
-    // Set table format
-    QTextTableFormat tableFormat;
-    tableFormat.setBorder(1);
-    tableFormat.setCellPadding(5);
-    tableFormat.setHeaderRowCount(1);
-    tableFormat.setAlignment(Qt::AlignCenter);
-    table->setFormat(tableFormat);
-
-    // Add column headers
-    QTextCharFormat headerFormat;
-    headerFormat.setFontWeight(QFont::Bold);
-    headerFormat.setBackground(QColor(230, 230, 230));
-
-    for (int col = 0; col < columnCount; ++col) {
-        QTextTableCell cell = table->cellAt(0, col);
-        cell.setFormat(headerFormat);
-        QTextCursor cellCursor = cell.firstCursorPosition();
-        cellCursor.insertText(proxyModel->headerData(col, Qt::Horizontal).toString());
-    }
-
-    // Add table data
-    for (int row = 0; row < rowCount; ++row) {
-        for (int col = 0; col < columnCount; ++col) {
-            QModelIndex idx = proxyModel->index(row, col);
-            QVariant data = proxyModel->data(idx);
-
-            // Format dates nicely if this is the date column (column 1)
-            QString textData;
-            if (col == 1 && data.typeId() == QMetaType::QDateTime) {
-
-                textData = data.toDateTime().toString("yyyy-MM-dd HH:mm");
-            } else {
-                textData = data.toString();
-            }
-
-            QTextTableCell cell = table->cellAt(row + 1, col);
-            QTextCursor cellCursor = cell.firstCursorPosition();
-            cellCursor.insertText(textData);
-        }
-    }
-
-    // Add timestamp at the bottom
-    cursor.movePosition(QTextCursor::End);
-    cursor.insertText("\n\nGenerated on: " + QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss"));
+    // Capture what the view shows right now: the store snapshot plus the
+    // view's filters and sort. Both are O(1) copies; the order is rebuilt on
+    // the worker, and edits made while the job runs do not leak into it.
+    const QVector<Match> matches = matchStore->snapshot();
+    const quint64 version = matchStore->version();
+    const MatchFilterProxy::ViewState view = proxyModel->viewState();
 
-    // Print the document to the PDF file
-    doc.print(&printer);
+    QStringList headers;
+    for (int col = 0; col < proxyModel->columnCount(); ++col)
+        headers << proxyModel->headerData(col, Qt::Horizontal).toString();
+
+    // Paint the table on a worker thread, page by page
+    reportJobs->submit(tr("Matches PDF"), [matches, version, view, headers, fileName](QPromise<ReportJobResult> &promise) {
+        const QVector<int> order = view.order(matches, version);
+        MatchRowSource rows(matches, order, headers);
+        promise.setProgressRange(0, qMax(1, rows.size()));
+
+        TableReportWriter writer("Matches Report");
+        writer.setPageCache(&ReportCache::instance());
+        writer.setProgressCallback([&promise](int written) {
+            promise.setProgressValue(written);
+            return !promise.isCanceled();
+        });
 
-    QMessageBox::information(this, tr("PDF Export"), tr("PDF file exported successfully."));
+        ReportJobResult result;
+        result.ok = writer.writePdf(fileName, rows);
+        result.message = result.ok ? fileName : writer.errorString();
+        promise.addResult(result);
+    });
 }
 
 // Method for statistics
@@ -1382,135 +1681,126 @@ void MainWindow::on_pushButton_MatchStats_clicked()
 
 void MainWindow::showAttendanceStatsDialog()
 {
-    // Create a dialog to display the stats
-    QDialog statsDialog(this);
-    statsDialog.setWindowTitle("Holographic Attendance Statistics");
-    statsDialog.setMinimumSize(800, 600);
-    statsDialog.setStyleSheet("background-color: #0a192f;"); // Dark blue background for hologram effect
-
-    // Create layout
-    QVBoxLayout *layout = new QVBoxLayout(&statsDialog);
-
-    // Add title
-    QLabel *titleLabel = new QLabel("Holographic Attendance per Match Type", &statsDialog);
-    QFont titleFont = titleLabel->font();
-    titleFont.setBold(true);
-    titleFont.setPointSize(16);
-    titleLabel->setFont(titleFont);
-    titleLabel->setAlignment(Qt::AlignCenter);
-    titleLabel->setStyleSheet("color: #00e5ff; margin: 10px;"); // Cyan text for hologram feel
-    layout->addWidget(titleLabel);
-
-    // Create graphics view for our hologram visualization
-    QGraphicsView *graphicsView = new QGraphicsView(&statsDialog);
-    QGraphicsScene *scene = new QGraphicsScene(graphicsView);
-    graphicsView->setScene(scene);
-    graphicsView->setRenderHint(QPainter::Antialiasing);
-    graphicsView->setBackgroundBrush(QBrush(QColor("#0a192f"))); // Dark blue background
-    graphicsView->setFrameStyle(QFrame::NoFrame);
-
-    // Modified SQL query to only include specific match types
-    QSqlQuery query(connection->getConnection());
-    query.prepare("SELECT TYPEMATCH, AVG(TO_NUMBER(SPECTATEURS)) as AverageAttendance, "
-                  "COUNT(*) as MatchCount FROM MATCHES "
-                  "WHERE TYPEMATCH IN ('compétitif', 'championnat', 'amicale') "
-                  "AND TYPEMATCH IS NOT NULL "
-                  "GROUP BY TYPEMATCH ORDER BY TYPEMATCH");
+    // One live dashboard; asking again just brings it to the front
+    if (!statsDashboard) {
+        StatsDashboard *dashboard = new StatsDashboard(attendanceStats, matchStore, this);
+
+        // If no data was found, show a message and return
+        if (!dashboard->hasData()) {
+            delete dashboard;
+            QMessageBox::information(this, "No Data",
+                                     "No matches found with the specified types (compétitif, championnat, amicale).");
+            return;
+        }
 
-    if (!query.exec()) {
-        QMessageBox::critical(this, "Database Error",
-                              "Failed to calculate statistics: " + query.lastError().text());
-        return;
+        dashboard->setAttribute(Qt::WA_DeleteOnClose);
+        connect(dashboard, &StatsDashboard::exportPdfRequested, this, &MainWindow::exportHologramStatsToPdf);
+        connect(dashboard, &StatsDashboard::exportSvgRequested, this, &MainWindow::exportHologramStatsToSvg);
+        statsDashboard = dashboard;
     }
 
-    // Collect data for visualization
-    QStringList matchTypes;
-    QVector<double> avgAttendances;
-    QVector<int> matchCounts;
-    double maxAttendance = 0;
-
-    while (query.next()) {
-        QString matchType = query.value("TYPEMATCH").toString();
-        double avgAttendance = query.value("AverageAttendance").toDouble();
-        int matchCount = query.value("MatchCount").toInt();
-
-        matchTypes.append(matchType);
-        avgAttendances.append(avgAttendance);
-        matchCounts.append(matchCount);
+    statsDashboard->show();
+    statsDashboard->raise();
+    statsDashboard->activateWindow();
+}
 
-        if (avgAttendance > maxAttendance) {
-            maxAttendance = avgAttendance;
+// Records the hologram scene as vector drawing commands. Replaying the
+// picture later needs neither the scene nor the GUI thread. Bars are drawn
+// at rest, without the glow pulse or a hover zoom, so the same data always
+// records the same picture and the export cache key (its bytes) can hit.
+static QPicture recordHologramScene(QGraphicsScene *scene, QSizeF *size)
+{
+    struct BarState
+    {
+        HologramBar *bar;
+        qreal opacity;
+        qreal hoverProgress;
+    };
+    QList<BarState> bars;
+    const QList<QGraphicsItem *> items = scene->items();
+    for (QGraphicsItem *item : items) {
+        if (HologramBar *bar = dynamic_cast<HologramBar *>(item)) {
+            bars.append({bar, bar->opacity(), bar->hoverProgress()});
+            bar->setOpacity(1.0);
+            bar->setHoverProgress(0.0);
         }
     }
 
-    // If no data was found, show a message and return
-    if (matchTypes.isEmpty()) {
-        QMessageBox::information(this, "No Data",
-                                 "No matches found with the specified types (compétitif, championnat, amicale).");
-        return;
+    QRectF sceneRect = scene->itemsBoundingRect();
+    QPicture picture;
+    QPainter recorder(&picture);
+    recorder.setRenderHint(QPainter::Antialiasing, true);
+    recorder.setRenderHint(QPainter::TextAntialiasing, true);
+    scene->render(&recorder, QRectF(QPointF(0, 0), sceneRect.size()), sceneRect, Qt::KeepAspectRatio);
+    recorder.end();
+    *size = sceneRect.size();
+
+    // Back to the live look before the next frame
+    for (const BarState &state : std::as_const(bars)) {
+        state.bar->setOpacity(state.opacity);
+        state.bar->setHoverProgress(state.hoverProgress);
     }
+    return picture;
+}
 
-    // Calculate layout - use a grid layout for more predictable positioning
-    const int MAX_ITEMS_PER_ROW = 3;
-    const int MAX_DIAMETER = 200;
-    const int SPACING = 50;
-
-    // Calculate how many rows we need
-    int numRows = (matchTypes.size() + MAX_ITEMS_PER_ROW - 1) / MAX_ITEMS_PER_ROW;
-
-    // For each match type, create a hologram circle
-    for (int i = 0; i < matchTypes.size(); ++i) {
-        // Calculate grid position (row, column)
-        int row = i / MAX_ITEMS_PER_ROW;
-        int col = i % MAX_ITEMS_PER_ROW;
-
-        // Calculate size proportional to attendance
-        double sizeRatio = avgAttendances[i] / maxAttendance;
-        int diameter = qMax(80, int(sizeRatio * MAX_DIAMETER));
-
-        // Calculate position with even spacing
-        int xCenter = col * (MAX_DIAMETER + SPACING) + MAX_DIAMETER/2;
-        int yCenter = row * (MAX_DIAMETER + SPACING) + MAX_DIAMETER/2;
-
-        // Create hologram bar with circle shape
-        HologramBar *bar = new HologramBar(matchTypes[i], avgAttendances[i], matchCounts[i]);
-        bar->setRect(xCenter - diameter/2, yCenter - diameter/2, diameter, diameter);
-
-        // Add reflection effect
-        QGraphicsEllipseItem *reflection = new QGraphicsEllipseItem(
-            xCenter - diameter/4, yCenter + diameter/2 + 10,
-            diameter/2, diameter/5);
-
-        QLinearGradient reflectionGradient(0, yCenter + diameter/2, 0, yCenter + diameter/2 + diameter/5);
-        reflectionGradient.setColorAt(0.0, QColor(0, 200, 255, 100));
-        reflectionGradient.setColorAt(1.0, QColor(0, 100, 200, 0));
-        reflection->setBrush(reflectionGradient);
-        reflection->setPen(Qt::NoPen);
-
-        scene->addItem(bar);
-        scene->addItem(reflection);
-    }
+// Lays out the hologram report page: title, the scene centred below it and
+// the footer button. Everything is replayed as vector primitives, so PDF and
+// SVG output stay sharp at any zoom.
+static void paintHologramReport(QPainter &painter, const QRectF &pageRect,
+                                const QPicture &scenePicture, const QSizeF &sceneSize)
+{
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setRenderHint(QPainter::TextAntialiasing, true);
 
-    // Set the scene rect to contain all items with padding
-    scene->setSceneRect(scene->itemsBoundingRect().adjusted(-50, -50, 50, 50));
+    // Fill the background with white color
+    painter.fillRect(pageRect, Qt::white);
 
-    // Add the graphics view to layout
-    layout->addWidget(graphicsView);
+    // Sizes are relative to the page so any device resolution looks the same
+    const qreal unit = pageRect.height() / 600.0;
 
-    // Add export button
-    QPushButton *exportButton = new QPushButton("Export to PDF", &statsDialog);
-    exportButton->setStyleSheet("background-color: #003366; color: white; padding: 8px; border-radius: 5px;");
-    connect(exportButton, &QPushButton::clicked, [this, scene]() {
-        exportHologramStatsToPdf(scene);
-    });
-    layout->addWidget(exportButton);
+    // Draw the title with the holographic cyan color
+    QFont titleFont("Arial");
+    titleFont.setPixelSize(qMax(1, qRound(24 * unit)));
+    titleFont.setBold(true);
+    painter.setFont(titleFont);
+    painter.setPen(QColor("#00e5ff"));
+    painter.drawText(QRectF(0, 20 * unit, pageRect.width(), 60 * unit),
+                     Qt::AlignHCenter, "Holographic Attendance per Match Type");
+
+    // Scene content area between the title and the button
+    QRectF contentRect(10 * unit, 80 * unit, pageRect.width() - 20 * unit, pageRect.height() - 150 * unit);
+    if (!sceneSize.isEmpty()) {
+        // Scale down slightly to leave margins, and centre
+        QSizeF fitted = sceneSize.scaled(contentRect.size() * 0.9, Qt::KeepAspectRatio);
+        painter.save();
+        painter.setClipRect(contentRect);
+        painter.translate(contentRect.center().x() - fitted.width() / 2,
+                          contentRect.center().y() - fitted.height() / 2);
+        painter.scale(fitted.width() / sceneSize.width(), fitted.height() / sceneSize.height());
+        painter.drawPicture(0, 0, scenePicture);
+        painter.restore();
+    }
 
-    // Show the dialog
-    statsDialog.exec();
+    // Draw the "Export to PDF" button at the bottom
+    QRectF buttonRect(pageRect.width() * 0.25, pageRect.height() - 40 * unit,
+                      pageRect.width() * 0.5, 30 * unit);
+
+    // Draw button background
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(QColor("#003366"));
+    painter.drawRoundedRect(buttonRect, 5 * unit, 5 * unit);
+
+    // Draw button text
+    painter.setPen(Qt::white);
+    QFont buttonFont("Arial");
+    buttonFont.setPixelSize(qMax(1, qRound(13 * unit)));
+    painter.setFont(buttonFont);
+    painter.drawText(buttonRect, Qt::AlignCenter, "Export to PDF");
 }
 
 void MainWindow::exportHologramStatsToPdf(QGraphicsScene *scene)
 {
+    PB_TRACE_SCOPE("export.hologram-pdf");
     // Ask user for the file location to save PDF
     QString fileName = QFileDialog::getSaveFileName(this, tr("Export Hologram Stats to PDF"),
                                                     QString(), tr("PDF Files (*.pdf)"));
@@ -1521,107 +1811,341 @@ void MainWindow::exportHologramStatsToPdf(QGraphicsScene *scene)
     if (!fileName.endsWith(".pdf", Qt::CaseInsensitive))
         fileName += ".pdf";
 
-    // Set up printer for PDF export
-    QPrinter printer(QPrinter::HighResolution);
-    printer.setOutputFormat(QPrinter::PdfFormat);
-    printer.setOutputFileName(fileName);
-    printer.setPageOrientation(QPageLayout::Landscape);
+    // Record the scene as it looks now; the worker only replays this picture,
+    // so the dialog can animate or close while the PDF is written
+    QSizeF sceneSize;
+    QPicture scenePicture = recordHologramScene(scene, &sceneSize);
+
+    reportJobs->submit(tr("Hologram PDF"), [scenePicture, sceneSize, fileName](QPromise<ReportJobResult> &promise) {
+        // The recorded drawing commands are the report's whole input
+        const QByteArray cacheKey = ReportKey("hologram-pdf/v1")
+                                        .add(QByteArray(scenePicture.data(), scenePicture.size()))
+                                        .add(qint64(sceneSize.width())).add(qint64(sceneSize.height()))
+                                        .result();
+        ReportJobResult result;
+        if (ReportCache::instance().copyTo(cacheKey, "pdf", fileName)) {
+            result.ok = true;
+            result.message = fileName;
+            promise.addResult(result);
+            return;
+        }
 
-    // Use a page size that matches your desired aspect ratio
-    QPageSize customSize(QSizeF(800, 600), QPageSize::Point, "Custom");
-    printer.setPageSize(customSize);
+        {
+            QPdfWriter pdf(fileName);
+            pdf.setResolution(1200);
 
-    // Set minimal margins
-    printer.setPageMargins(QMarginsF(10, 10, 10, 10), QPageLayout::Millimeter);
+            // Use a page size that matches your desired aspect ratio
+            QPageSize customSize(QSizeF(800, 600), QPageSize::Point, "Custom");
+            pdf.setPageSize(customSize);
+            pdf.setPageOrientation(QPageLayout::Landscape);
 
-    // Create painter for the PDF
-    QPainter pdfPainter(&printer);
-    pdfPainter.setRenderHint(QPainter::Antialiasing, true);
-    pdfPainter.setRenderHint(QPainter::TextAntialiasing, true);
-    pdfPainter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+            // Set minimal margins
+            pdf.setPageMargins(QMarginsF(10, 10, 10, 10), QPageLayout::Millimeter);
 
-    // Get printable area
-    QRectF pageRect = printer.pageRect(QPrinter::DevicePixel);
+            QPainter pdfPainter;
+            if (!pdfPainter.begin(&pdf)) {
+                result.message = "Cannot open the output file for writing.";
+                promise.addResult(result);
+                return;
+            }
+            paintHologramReport(pdfPainter, QRectF(0, 0, pdf.width(), pdf.height()), scenePicture, sceneSize);
+            result.ok = pdfPainter.end();
+            result.message = result.ok ? fileName : QString("Failed to finish the PDF file.");
+        }
+        if (result.ok)
+            ReportCache::instance().store(cacheKey, "pdf", fileName);
+        else
+            QFile::remove(fileName);
+        promise.addResult(result);
+    });
+}
 
-    // Fill the background with white color
-    pdfPainter.fillRect(pageRect, Qt::white);
+void MainWindow::exportHologramStatsToSvg(QGraphicsScene *scene)
+{
+    PB_TRACE_SCOPE("export.hologram-svg");
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Export Hologram Stats to SVG"),
+                                                    QString(), tr("SVG Files (*.svg)"));
+    if (fileName.isEmpty())
+        return;
 
-    // Draw the title with the holographic cyan color
-    QFont titleFont("Arial", 18, QFont::Bold);
-    pdfPainter.setFont(titleFont);
-    pdfPainter.setPen(QColor("#00e5ff"));
-    pdfPainter.drawText(QRectF(0, 20, pageRect.width(), 60),
-                        Qt::AlignHCenter, "Holographic Attendance per Match Type");
+    if (!fileName.endsWith(".svg", Qt::CaseInsensitive))
+        fileName += ".svg";
+
+    QSizeF sceneSize;
+    QPicture scenePicture = recordHologramScene(scene, &sceneSize);
+
+    reportJobs->submit(tr("Hologram SVG"), [scenePicture, sceneSize, fileName](QPromise<ReportJobResult> &promise) {
+        const QByteArray cacheKey = ReportKey("hologram-svg/v1")
+                                        .add(QByteArray(scenePicture.data(), scenePicture.size()))
+                                        .add(qint64(sceneSize.width())).add(qint64(sceneSize.height()))
+                                        .result();
+        ReportJobResult result;
+        if (ReportCache::instance().copyTo(cacheKey, "svg", fileName)) {
+            result.ok = true;
+            result.message = fileName;
+            promise.addResult(result);
+            return;
+        }
+
+        // Same 800x600 page as the PDF, in SVG user units
+        const QRectF pageRect(0, 0, 800, 600);
+        QSvgGenerator svg;
+        svg.setFileName(fileName);
+        svg.setSize(pageRect.size().toSize());
+        svg.setViewBox(pageRect);
+        svg.setTitle("Holographic Attendance per Match Type");
+
+        QPainter svgPainter;
+        if (!svgPainter.begin(&svg)) {
+            result.message = "Cannot open the output file for writing.";
+            promise.addResult(result);
+            return;
+        }
+        paintHologramReport(svgPainter, pageRect, scenePicture, sceneSize);
+        result.ok = svgPainter.end();
+        result.message = result.ok ? fileName : QString("Failed to finish the SVG file.");
+        if (result.ok)
+            ReportCache::instance().store(cacheKey, "svg", fileName);
+        promise.addResult(result);
+    });
+}
 
-    // Create a separate image for the scene content only
-    QImage sceneImage(pageRect.width() - 20, pageRect.height() - 150, QImage::Format_ARGB32);
-    sceneImage.fill(Qt::transparent); // Make it transparent
+void MainWindow::showBatchReportDialog()
+{
+    // Ask how to split the reports
+    QDialog batchDialog(this);
+    batchDialog.setWindowTitle("Batch Reports");
+    QFormLayout *form = new QFormLayout(&batchDialog);
 
-    QPainter scenePainter(&sceneImage);
-    scenePainter.setRenderHint(QPainter::Antialiasing, true);
-    scenePainter.setRenderHint(QPainter::TextAntialiasing, true);
+    QComboBox *partitionCombo = new QComboBox(&batchDialog);
+    partitionCombo->addItem("One report per venue");
+    partitionCombo->addItem("One report per month");
+    partitionCombo->addItem("One report per venue and month");
+    form->addRow("Partition:", partitionCombo);
 
-    // Calculate the content area size
-    QRectF sceneRect = scene->itemsBoundingRect();
+    QHBoxLayout *buttonLayout = new QHBoxLayout();
+    QPushButton *generateButton = new QPushButton("Choose Folder && Generate", &batchDialog);
+    QPushButton *cancelButton = new QPushButton("Cancel", &batchDialog);
+    buttonLayout->addWidget(generateButton);
+    buttonLayout->addWidget(cancelButton);
+    form->addRow(buttonLayout);
+    connect(generateButton, &QPushButton::clicked, &batchDialog, &QDialog::accept);
+    connect(cancelButton, &QPushButton::clicked, &batchDialog, &QDialog::reject);
+
+    if (batchDialog.exec() != QDialog::Accepted)
+        return;
 
-    // Scale and position to center the content
-    double xScale = (sceneImage.width() / sceneRect.width());
-    double yScale = (sceneImage.height() / sceneRect.height());
-    double scale = qMin(xScale, yScale) * 0.9; // Scale down slightly to leave margins
+    QString outputDir = QFileDialog::getExistingDirectory(this, tr("Batch Reports Folder"));
+    if (outputDir.isEmpty())
+        return;
 
-    // Ensure we have enough space and adjust scaling
-    if (scale < 1.0) {
-        scenePainter.translate(sceneImage.width() / 2, sceneImage.height() / 2);
-        scenePainter.scale(scale, scale);
-        scenePainter.translate(-sceneRect.center().x(), -sceneRect.center().y());
+    QList<AttendanceCube::Dimension> partitionBy;
+    switch (partitionCombo->currentIndex()) {
+    case 0:
+        partitionBy << AttendanceCube::Venue;
+        break;
+    case 1:
+        partitionBy << AttendanceCube::Month;
+        break;
+    default:
+        partitionBy << AttendanceCube::Venue << AttendanceCube::Month;
+        break;
     }
 
-    // Only render the items (not the background)
-    scene->render(&scenePainter, QRectF(), sceneRect, Qt::KeepAspectRatio);
-    scenePainter.end();
+    QStringList headers;
+    for (int col = 0; col < proxyModel->columnCount(); ++col)
+        headers << proxyModel->headerData(col, Qt::Horizontal).toString();
 
-    // Draw the scene image to the PDF, adjusting the position
-    pdfPainter.drawImage(QPointF(10, 80), sceneImage); // Adjusted position
+    // Partitions come from one store snapshot, so the whole pack is consistent
+    ReportBatch batch(matchStore->snapshot(), partitionBy, headers, outputDir);
+    if (batch.parts().isEmpty()) {
+        QMessageBox::information(this, "Batch Reports", "No matches to report.");
+        return;
+    }
 
-    // Draw the "Export to PDF" button at the bottom
-    QRectF buttonRect(pageRect.width() * 0.25, pageRect.height() - 40,
-                      pageRect.width() * 0.5, 30);
+    reportJobs->submit(tr("Batch reports (%1 files)").arg(batch.parts().size()),
+                       [batch](QPromise<ReportJobResult> &promise) mutable {
+        batch.run(promise);
+    });
+}
 
-    // Draw button background
-    pdfPainter.setPen(Qt::NoPen);
-    pdfPainter.setBrush(QColor("#003366"));
-    pdfPainter.drawRoundedRect(buttonRect, 5, 5);
+void MainWindow::onReportJobFinished(const QString &title, bool ok, bool cancelled, const QString &message)
+{
+    if (reportJobs->activeJobs() == 0) {
+        jobProgressBar->hide();
+        jobCancelButton->hide();
+    }
 
-    // Draw button text
-    pdfPainter.setPen(Qt::white);
-    QFont buttonFont("Arial", 10);
-    pdfPainter.setFont(buttonFont);
-    pdfPainter.drawText(buttonRect, Qt::AlignCenter, "Export to PDF");
+    if (cancelled) {
+        ui->statusbar->showMessage(tr("%1 cancelled.").arg(title), 5000);
+        return;
+    }
 
-    pdfPainter.end();
+    if (!ok) {
+        qDebug() << "Report job failed:" << title << message;
+        QMessageBox::critical(this, title, tr("Export failed: %1").arg(message));
+        return;
+    }
 
-    // Notify user of success
-    QMessageBox::information(this, tr("PDF Export"), tr("Hologram statistics exported to PDF successfully."));
+    // Non-blocking notification; flash the taskbar entry if the window is in the background
+    ui->statusbar->showMessage(tr("%1 saved to %2").arg(title, message), 10000);
+    QApplication::alert(this);
 }
+
 // Update the calculateAttendanceStats method to call the hologram version
 void MainWindow::calculateAttendanceStats()
 {
-    // Create a query to calculate average attendance per match type
-    QSqlQuery query(connection->getConnection());
-
-    // Use the correct column name from your database (SPECTATEURS)
-    query.prepare("SELECT TYPEMATCH, AVG(TO_NUMBER(SPECTATEURS)) as AverageAttendance, "
-                  "COUNT(*) as MatchCount FROM MATCHES GROUP BY TYPEMATCH ORDER BY TYPEMATCH");
-
-    if (!query.exec()) {
-        QMessageBox::critical(this, "Database Error",
-                              "Failed to calculate statistics: " + query.lastError().text());
-        return;
+    // Aggregates follow the cached matches; only hit the database if those never loaded
+    if (matchStore->version() == 0) {
+        QVector<Match> matches;
+        QString error;
+        if (!MatchStore::loadAll(connection->getConnection(), matches, &error)) {
+            QMessageBox::critical(this, "Database Error", "Failed to calculate statistics: " + error);
+            return;
+        }
+        matchStore->setMatches(matches);
     }
 
     // Display the results in the hologram dialog
     showAttendanceStatsDialog();
 }
+void MainWindow::showAttendanceAnalyticsDialog()
+{
+    // Create a dialog for slicing attendance by several dimensions
+    QDialog analyticsDialog(this);
+    analyticsDialog.setWindowTitle("Attendance Analytics");
+    analyticsDialog.setMinimumSize(900, 500);
+
+    QVBoxLayout *layout = new QVBoxLayout(&analyticsDialog);
+
+    // Dimension selector and drill-down path
+    QHBoxLayout *controlsLayout = new QHBoxLayout();
+    QLabel *groupLabel = new QLabel("Group by:", &analyticsDialog);
+    QComboBox *dimensionCombo = new QComboBox(&analyticsDialog);
+    const QList<AttendanceCube::Dimension> dimensions = {
+        AttendanceCube::Type, AttendanceCube::Venue, AttendanceCube::Month,
+        AttendanceCube::Weekday, AttendanceCube::Status
+    };
+    for (AttendanceCube::Dimension dimension : dimensions)
+        dimensionCombo->addItem(AttendanceCube::dimensionName(dimension), int(dimension));
+    QPushButton *backButton = new QPushButton("Back", &analyticsDialog);
+    backButton->setEnabled(false);
+    QLabel *pathLabel = new QLabel("All matches", &analyticsDialog);
+
+    controlsLayout->addWidget(groupLabel);
+    controlsLayout->addWidget(dimensionCombo);
+    controlsLayout->addWidget(backButton);
+    controlsLayout->addWidget(pathLabel, 1);
+    layout->addLayout(controlsLayout);
+
+    // Results
+    QTreeWidget *resultsTree = new QTreeWidget(&analyticsDialog);
+    QStringList headers;
+    headers << "Slice" << "Matches" << "Average" << "Median" << "P90" << "Min" << "Max" << "Trend / month";
+    resultsTree->setHeaderLabels(headers);
+    resultsTree->setRootIsDecorated(false);
+    resultsTree->setSortingEnabled(true);
+    resultsTree->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    layout->addWidget(resultsTree);
+
+    QLabel *hintLabel = new QLabel("Double-click a slice to drill down.", &analyticsDialog);
+    layout->addWidget(hintLabel);
+
+    QPushButton *closeButton = new QPushButton("Close", &analyticsDialog);
+    connect(closeButton, &QPushButton::clicked, &analyticsDialog, &QDialog::accept);
+    layout->addWidget(closeButton);
+
+    // Rollups run on the thread pool over a snapshot of the cached matches
+    const QVector<Match> snapshot = matchStore->snapshot();
+    AttendanceCube::Filter drillPath;
+    QFutureWatcher<QHash<QString, CubeCell>> watcher;
+
+    auto currentDimension = [dimensionCombo]() {
+        return AttendanceCube::Dimension(dimensionCombo->currentData().toInt());
+    };
+
+    auto rebuild = [&]() {
+        if (watcher.isRunning())
+            watcher.waitForFinished();
+
+        QStringList parts;
+        for (const auto &step : drillPath)
+            parts << AttendanceCube::dimensionName(step.first) + " = " + step.second;
+        pathLabel->setText(parts.isEmpty() ? QString("All matches") : parts.join("  >  "));
+        backButton->setEnabled(!drillPath.isEmpty());
+
+        dimensionCombo->setEnabled(false);
+        resultsTree->setEnabled(false);
+        AttendanceCube::Dimension groupBy = currentDimension();
+        AttendanceCube::Filter filter = drillPath;
+        watcher.setFuture(QtConcurrent::run([snapshot, groupBy, filter]() {
+            return AttendanceCube::rollup(snapshot, groupBy, filter);
+        }));
+    };
+
+    connect(&watcher, &QFutureWatcher<QHash<QString, CubeCell>>::finished, &analyticsDialog, [&]() {
+        const QHash<QString, CubeCell> cells = watcher.result();
+
+        resultsTree->setSortingEnabled(false);
+        resultsTree->clear();
+        for (auto it = cells.cbegin(); it != cells.cend(); ++it) {
+            const CubeCell &cell = it.value();
+            QTreeWidgetItem *item = new QTreeWidgetItem(resultsTree);
+            item->setText(0, it.key());
+            item->setData(1, Qt::DisplayRole, cell.matches);
+            item->setData(2, Qt::DisplayRole, qRound(cell.average()));
+            item->setData(3, Qt::DisplayRole, qRound(cell.median()));
+            item->setData(4, Qt::DisplayRole, qRound(cell.p90()));
+            item->setData(5, Qt::DisplayRole, cell.minimum);
+            item->setData(6, Qt::DisplayRole, cell.maximum);
+            item->setData(7, Qt::DisplayRole, qRound(cell.trendPerMonth() * 10) / 10.0);
+        }
+        resultsTree->setSortingEnabled(true);
+        resultsTree->sortByColumn(0, Qt::AscendingOrder);
+
+        dimensionCombo->setEnabled(true);
+        resultsTree->setEnabled(true);
+    });
+
+    connect(dimensionCombo, &QComboBox::currentIndexChanged, &analyticsDialog, [&]() {
+        rebuild();
+    });
+
+    connect(resultsTree, &QTreeWidget::itemDoubleClicked, &analyticsDialog, [&](QTreeWidgetItem *item) {
+        // Drill into the slice and group it by the next unused dimension
+        drillPath.append(qMakePair(currentDimension(), item->text(0)));
+        for (int i = 0; i < dimensionCombo->count(); ++i) {
+            AttendanceCube::Dimension candidate = AttendanceCube::Dimension(dimensionCombo->itemData(i).toInt());
+            bool used = false;
+            for (const auto &step : drillPath)
+                used = used || step.first == candidate;
+            if (!used) {
+                QSignalBlocker blocker(dimensionCombo);
+                dimensionCombo->setCurrentIndex(i);
+                break;
+            }
+        }
+        rebuild();
+    });
+
+    connect(backButton, &QPushButton::clicked, &analyticsDialog, [&]() {
+        if (drillPath.isEmpty())
+            return;
+        auto step = drillPath.takeLast();
+        {
+            QSignalBlocker blocker(dimensionCombo);
+            dimensionCombo->setCurrentIndex(dimensionCombo->findData(int(step.first)));
+        }
+        rebuild();
+    });
+
+    rebuild();
+
+    // Show the dialog
+    analyticsDialog.exec();
+    watcher.waitForFinished();
+}
+
 // Calendar functions
 void MainWindow::on_pushButton_Calendar_clicked()
 {
@@ -1687,7 +2211,7 @@ void MainWindow::loadMatchDates()
     matchDates.clear();
 
     // Query the database for all match dates
-    QSqlQuery query(connection->getConnection());
+    ProfiledQuery query("Calendar match dates", connection->getConnection());
     query.prepare("SELECT DATEMATCH FROM MATCHES");
 
     if (!query.exec()) {
@@ -1743,7 +2267,7 @@ void MainWindow::highlightMatchDates()
 void MainWindow::onCalendarClicked(const QDate &date)
 {
     // Get matches for the selected date
-    QSqlQuery query(connection->getConnection());
+    ProfiledQuery query("Calendar matches by day", connection->getConnection());
     query.prepare("SELECT IDMATCH, DATEMATCH, LIEU, STATUS, SCORE, TYPEMATCH, SPECTATEURS FROM MATCHES "
                   "WHERE TRUNC(DATEMATCH) = :date ORDER BY DATEMATCH");
 
@@ -1838,3 +2362,105 @@ void MainWindow::refreshCalendar()
         highlightMatchDates();
     }
 }
+
+void MainWindow::showQueryDiagnosticsDialog()
+{
+    // Create a dialog listing per-statement timings
+    QDialog diagnosticsDialog(this);
+    diagnosticsDialog.setWindowTitle("Query Diagnostics");
+    diagnosticsDialog.setMinimumSize(900, 400);
+
+    QVBoxLayout *layout = new QVBoxLayout(&diagnosticsDialog);
+
+    QueryProfiler &profiler = QueryProfiler::instance();
+
+    // Slow-query threshold
+    QHBoxLayout *thresholdLayout = new QHBoxLayout();
+    QLabel *thresholdLabel = new QLabel("Slow query threshold (ms):", &diagnosticsDialog);
+    QSpinBox *thresholdSpin = new QSpinBox(&diagnosticsDialog);
+    thresholdSpin->setRange(0, 600000);
+    thresholdSpin->setValue(profiler.slowQueryThresholdMs());
+    connect(thresholdSpin, &QSpinBox::valueChanged, [&profiler](int ms) {
+        profiler.setSlowQueryThresholdMs(ms);
+    });
+    thresholdLayout->addWidget(thresholdLabel);
+    thresholdLayout->addWidget(thresholdSpin);
+    thresholdLayout->addStretch();
+    layout->addLayout(thresholdLayout);
+
+    QLabel *logLabel = new QLabel("Slow query log: " + profiler.slowQueryLogPath(), &diagnosticsDialog);
+    logLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    layout->addWidget(logLabel);
+
+    // Statistics table
+    QTableWidget *statsTable = new QTableWidget(&diagnosticsDialog);
+    QStringList headers;
+    headers << "Statement" << "Executions" << "Failures" << "Rows" << "Bytes"
+            << "Avg prepare (ms)" << "Avg exec (ms)" << "Avg fetch (ms)"
+            << "p50 (ms)" << "p95 (ms)" << "p99 (ms)";
+    statsTable->setColumnCount(headers.size());
+    statsTable->setHorizontalHeaderLabels(headers);
+    statsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    statsTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    statsTable->setSortingEnabled(true);
+    layout->addWidget(statsTable);
+
+    auto fillTable = [statsTable, &profiler]() {
+        auto ms = [](double micros) {
+            QTableWidgetItem *item = new QTableWidgetItem();
+            item->setData(Qt::DisplayRole, qRound64(micros) / 1000.0);
+            return item;
+        };
+        auto number = [](qint64 value) {
+            QTableWidgetItem *item = new QTableWidgetItem();
+            item->setData(Qt::DisplayRole, value);
+            return item;
+        };
+
+        const QList<QueryStatementStats> stats = profiler.snapshot();
+        statsTable->setSortingEnabled(false);
+        statsTable->setRowCount(stats.size());
+        for (int row = 0; row < stats.size(); ++row) {
+            const QueryStatementStats &s = stats[row];
+            double runs = qMax<qint64>(1, s.executions);
+
+            QTableWidgetItem *labelItem = new QTableWidgetItem(s.label);
+            labelItem->setToolTip(s.sql.simplified());
+            statsTable->setItem(row, 0, labelItem);
+            statsTable->setItem(row, 1, number(s.executions));
+            statsTable->setItem(row, 2, number(s.failures));
+            statsTable->setItem(row, 3, number(s.rows));
+            statsTable->setItem(row, 4, number(s.bytes));
+            statsTable->setItem(row, 5, ms(s.prepareMicros / runs));
+            statsTable->setItem(row, 6, ms(s.execMicros / runs));
+            statsTable->setItem(row, 7, ms(s.fetchMicros / runs));
+            statsTable->setItem(row, 8, ms(s.latency.percentile(0.50)));
+            statsTable->setItem(row, 9, ms(s.latency.percentile(0.95)));
+            statsTable->setItem(row, 10, ms(s.latency.percentile(0.99)));
+        }
+        statsTable->setSortingEnabled(true);
+        statsTable->sortByColumn(10, Qt::DescendingOrder);
+    };
+    fillTable();
+
+    // Buttons
+    QHBoxLayout *buttonLayout = new QHBoxLayout();
+    QPushButton *refreshButton = new QPushButton("Refresh", &diagnosticsDialog);
+    QPushButton *resetButton = new QPushButton("Reset", &diagnosticsDialog);
+    QPushButton *closeButton = new QPushButton("Close", &diagnosticsDialog);
+    buttonLayout->addWidget(refreshButton);
+    buttonLayout->addWidget(resetButton);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(closeButton);
+    layout->addLayout(buttonLayout);
+
+    connect(refreshButton, &QPushButton::clicked, fillTable);
+    connect(resetButton, &QPushButton::clicked, [&profiler, fillTable]() {
+        profiler.reset();
+        fillTable();
+    });
+    connect(closeButton, &QPushButton::clicked, &diagnosticsDialog, &QDialog::accept);
+
+    // Show the dialog
+    diagnosticsDialog.exec();
+}
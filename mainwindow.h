@@ -23,12 +23,29 @@
 #include <QPrinter>
 #include <QPainter>
 
-#include <QSerialPort>
-#include <QSerialPortInfo>
+#include <QDockWidget>
+#include <QDateEdit>
+#include <QGroupBox>
+#include <QListWidget>
+#include <QSpinBox>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QAction>
+#include <QLabel>
+#include <QPointer>
 
 #include "hologrambar.h" // Include the separate hologrambar header
 
 #include "connection.h" // Make sure this header exists and contains your Connection class
+#include "attendancestats.h"
+#include "matches.h"
+#include "matchfilterproxy.h"
+#include "searchindex.h"
+#include "matchfilter.h"
+#include "reportjobs.h"
+#include "statsdashboard.h"
+#include "gatemanager.h"
+#include "telemetry.h"
 
 namespace Ui {
 class MainWindow;
@@ -62,7 +79,10 @@ private slots:
     void showAttendanceStatsDialog();
     void exportStatsTableToPdf(QTableWidget *table);
     void on_pushButton_MatchStats_clicked();
-    void filterByTypeMatch();
+    void showAttendanceAnalyticsDialog();
+    void searchMatches();
+    void populateFilterLists();
+    void applyFilters();
 
     // Calendar slots
     void on_pushButton_Calendar_clicked();
@@ -72,6 +92,16 @@ private slots:
     void on_pushButton_Simulate_clicked();
     void updateSimulation();
 
+    // Diagnostics slots
+    void showQueryDiagnosticsDialog();
+
+    // Background report slots
+    void showBatchReportDialog();
+    void onReportJobFinished(const QString &title, bool ok, bool cancelled, const QString &message);
+
+    // Turnstile telemetry
+    void updateOccupancyLabel();
+
 
 
 
@@ -79,8 +109,37 @@ private:
     Ui::MainWindow *ui;
     Connection *connection;
     QSqlTableModel *model;
-    QSortFilterProxyModel *proxyModel;
+    MatchFilterProxy *proxyModel;
     int currentId;
+    AttendanceAggregates *attendanceStats;
+    MatchStore *matchStore;
+    TrigramIndex searchIndex;
+
+    // Tools actions that read the match store; disabled until it has loaded
+    QAction *analyticsAction;
+    QAction *batchReportsAction;
+
+    // Filter panel members
+    QDockWidget *filterDock;
+    QGroupBox *filterDateGroup;
+    QDateEdit *filterFromEdit;
+    QDateEdit *filterToEdit;
+    QGroupBox *filterSpectateursGroup;
+    QSpinBox *filterMinSpin;
+    QSpinBox *filterMaxSpin;
+    QListWidget *filterStatusList;
+    QListWidget *filterTypeList;
+    QListWidget *filterVenueList;
+    QTimer *filterDebounce;
+    MatchFilterEngine filterEngine;
+
+    // Live statistics dashboard, null while closed
+    QPointer<StatsDashboard> statsDashboard;
+
+    // Background report members
+    ReportJobManager *reportJobs;
+    QProgressBar *jobProgressBar;
+    QPushButton *jobCancelButton;
 
     // Calendar members
     QCalendarWidget *calendar;
@@ -115,6 +174,11 @@ private:
     void loadMatchDates();
     void highlightMatchDates();
     void refreshCalendar();
+    void setupFilterPanel();
+    void startDatabase();
+    bool connectGuiThread();
+    void onDatabaseReady();
+    void setDatabaseWidgetsEnabled(bool enabled);
     void showMatchSimulation(int expectedTeamAScore, int expectedTeamBScore);
     void placePlayersInFormation();
 
@@ -125,8 +189,11 @@ private:
     void initializePlayersInFormation();
     void setupGame();
     void exportHologramStatsToPdf(QGraphicsScene *scene);
+    void exportHologramStatsToSvg(QGraphicsScene *scene);
 
-    QSerialPort *arduino;
+    GateManager *gateManager;
+    OccupancyTracker *occupancyTracker;
+    QLabel *occupancyLabel;
     void setupArduinoConnection();
     void sendStadiumCapacityToArduino(int spectatorCount);
     void resetStadiumBarrier();
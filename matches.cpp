@@ -0,0 +1,171 @@
+#include "matches.h"
+#include "queryprofiler.h"
+#include <QDebug>
+
+MatchStore::MatchStore(const QString &connectionName, QObject *parent)
+    : QObject(parent), m_connectionName(connectionName), m_version(0)
+{
+}
+
+const char *MatchStore::selectColumns()
+{
+    return "SELECT IDMATCH, DATEMATCH, LIEU, STATUS, SCORE, TYPEMATCH, SPECTATEURS FROM MATCHES";
+}
+
+const char *MatchStore::insertColumns()
+{
+    return "INSERT INTO MATCHES (DATEMATCH, LIEU, STATUS, SCORE, TYPEMATCH, SPECTATEURS) VALUES (?, ?, ?, ?, ?, ?)";
+}
+
+Match MatchStore::matchFromValues(const QVariant &id, const QVariant &date, const QVariant &lieu,
+                                  const QVariant &status, const QVariant &score, const QVariant &type,
+                                  const QVariant &spectateurs)
+{
+    Match match;
+    match.id = id.toInt();
+    match.date = date.toDateTime();
+    match.lieu = lieu.toString();
+    match.status = status.toString();
+    match.score = score.toString();
+    match.type = type.toString();
+    match.spectateursText = spectateurs.toString();
+
+    // SPECTATEURS is stored as text, parse it once here
+    bool ok = false;
+    int value = match.spectateursText.trimmed().toInt(&ok);
+    match.spectateurs = (ok && value >= 0) ? value : -1;
+    return match;
+}
+
+bool MatchStore::loadAll(const QSqlDatabase &db, QVector<Match> &matches, QString *error)
+{
+    ProfiledQuery query("MatchStore load", db);
+    query.setForwardOnly(true);
+    if (!query.exec(QString::fromLatin1(selectColumns()) + " ORDER BY IDMATCH")) {
+        if (error)
+            *error = query.lastError().text();
+        return false;
+    }
+
+    matches.clear();
+    while (query.next()) {
+        matches.append(matchFromValues(query.value(0), query.value(1), query.value(2), query.value(3),
+                                       query.value(4), query.value(5), query.value(6)));
+    }
+    return true;
+}
+
+bool MatchStore::load()
+{
+    QVector<Match> loaded;
+    QString error;
+    if (!loadAll(QSqlDatabase::database(m_connectionName), loaded, &error)) {
+        qDebug() << "Failed to load matches:" << error;
+        return false;
+    }
+    setMatches(loaded);
+    return true;
+}
+
+void MatchStore::setMatches(const QVector<Match> &matches)
+{
+    m_matches = matches;
+    rebuildIndex();
+    m_version++;
+    emit reloaded();
+}
+
+void MatchStore::rebuildIndex()
+{
+    m_rowById.clear();
+    m_rowById.reserve(m_matches.size());
+    for (int row = 0; row < m_matches.size(); ++row)
+        m_rowById.insert(m_matches[row].id, row);
+}
+
+const Match *MatchStore::find(int id) const
+{
+    auto it = m_rowById.constFind(id);
+    if (it == m_rowById.cend())
+        return nullptr;
+    return &m_matches[it.value()];
+}
+
+void MatchStore::insertMatch(const Match &match)
+{
+    m_rowById.insert(match.id, m_matches.size());
+    m_matches.append(match);
+    m_version++;
+    emit matchInserted(match);
+}
+
+bool MatchStore::syncNewMatches()
+{
+    int maxId = 0;
+    for (const Match &match : m_matches)
+        maxId = qMax(maxId, match.id);
+
+    ProfiledQuery query("MatchStore sync new", QSqlDatabase::database(m_connectionName));
+    query.prepare(QString::fromLatin1(selectColumns()) + " WHERE IDMATCH > ? ORDER BY IDMATCH");
+    query.bindValue(0, maxId);
+    if (!query.exec()) {
+        qDebug() << "Failed to fetch new matches:" << query.lastError().text();
+        return false;
+    }
+
+    while (query.next()) {
+        insertMatch(matchFromValues(query.value(0), query.value(1), query.value(2), query.value(3),
+                                    query.value(4), query.value(5), query.value(6)));
+    }
+    return true;
+}
+
+bool MatchStore::refreshMatch(int id)
+{
+    ProfiledQuery query("MatchStore refresh row", QSqlDatabase::database(m_connectionName));
+    query.prepare(QString::fromLatin1(selectColumns()) + " WHERE IDMATCH = ?");
+    query.bindValue(0, id);
+    if (!query.exec()) {
+        qDebug() << "Failed to refresh match" << id << ":" << query.lastError().text();
+        return false;
+    }
+
+    if (!query.next()) {
+        removeMatch(id);
+        return true;
+    }
+
+    Match fresh = matchFromValues(query.value(0), query.value(1), query.value(2), query.value(3),
+                                  query.value(4), query.value(5), query.value(6));
+    auto it = m_rowById.constFind(id);
+    if (it == m_rowById.cend()) {
+        insertMatch(fresh);
+        return true;
+    }
+
+    Match before = m_matches[it.value()];
+    m_matches[it.value()] = fresh;
+    m_version++;
+    emit matchUpdated(before, fresh);
+    return true;
+}
+
+void MatchStore::removeMatch(int id)
+{
+    auto it = m_rowById.constFind(id);
+    if (it == m_rowById.cend())
+        return;
+
+    // Swap with the last row so removal stays O(1)
+    int row = it.value();
+    Match removed = m_matches[row];
+    int last = m_matches.size() - 1;
+    if (row != last) {
+        m_matches[row] = m_matches[last];
+        m_rowById[m_matches[row].id] = row;
+    }
+    m_matches.removeLast();
+    m_rowById.remove(id);
+    m_version++;
+    emit matchRemoved(removed);
+}
@@ -1,4 +1,71 @@
 #ifndef MATCHES_H
 #define MATCHES_H
 
+#include <QObject>
+#include <QDateTime>
+#include <QHash>
+#include <QMetaType>
+#include <QSqlDatabase>
+#include <QString>
+#include <QVector>
+
+// One row of the MATCHES table
+struct Match
+{
+    int id = 0;
+    QDateTime date;
+    QString lieu;
+    QString status;
+    QString score;
+    QString type;
+    QString spectateursText;
+    int spectateurs = -1; // -1 when SPECTATEURS is empty or not numeric
+
+    bool hasSpectateurs() const { return spectateurs >= 0; }
+};
+Q_DECLARE_METATYPE(Match)
+
+// In-memory copy of the MATCHES table. Copies returned by snapshot() are
+// implicitly shared, so they are O(1) to take and safe to hand to worker threads.
+class MatchStore : public QObject
+{
+    Q_OBJECT
+public:
+    explicit MatchStore(const QString &connectionName, QObject *parent = nullptr);
+
+    static const char *selectColumns();
+    static const char *insertColumns(); // positional: DATEMATCH, LIEU, STATUS, SCORE, TYPEMATCH, SPECTATEURS
+    static Match matchFromValues(const QVariant &id, const QVariant &date, const QVariant &lieu,
+                                 const QVariant &status, const QVariant &score, const QVariant &type,
+                                 const QVariant &spectateurs);
+    static bool loadAll(const QSqlDatabase &db, QVector<Match> &matches, QString *error = nullptr);
+
+    bool load();
+    void setMatches(const QVector<Match> &matches);
+    bool syncNewMatches();          // picks up rows inserted with a higher IDMATCH
+    bool refreshMatch(int id);      // re-reads one row after an update
+    void removeMatch(int id);
+
+    QVector<Match> snapshot() const { return m_matches; }
+    const QVector<Match> &matches() const { return m_matches; }
+    const Match *find(int id) const;
+    int size() const { return m_matches.size(); }
+    quint64 version() const { return m_version; }
+
+signals:
+    void reloaded();
+    void matchInserted(const Match &match);
+    void matchUpdated(const Match &before, const Match &after);
+    void matchRemoved(const Match &match);
+
+private:
+    void rebuildIndex();
+    void insertMatch(const Match &match);
+
+    QString m_connectionName;
+    QVector<Match> m_matches;
+    QHash<int, int> m_rowById;
+    quint64 m_version;
+};
+
 #endif // MATCHES_H
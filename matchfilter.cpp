@@ -0,0 +1,315 @@
+#include "matchfilter.h"
+#include <algorithm>
+#include <limits>
+
+// MatchFilterCriteria implementation
+bool MatchFilterCriteria::isEmpty() const
+{
+    return !from.isValid() && !to.isValid() && minSpectateurs < 0 && maxSpectateurs < 0
+           && statuses.isEmpty() && types.isEmpty() && venues.isEmpty();
+}
+
+bool MatchFilterCriteria::isTighterThan(const MatchFilterCriteria &previous) const
+{
+    auto setTighter = [](const QSet<QString> &current, const QSet<QString> &before) {
+        return before.isEmpty() || (!current.isEmpty() && before.contains(current));
+    };
+
+    if (previous.from.isValid() && (!from.isValid() || from < previous.from))
+        return false;
+    if (previous.to.isValid() && (!to.isValid() || to > previous.to))
+        return false;
+    if (previous.minSpectateurs >= 0 && (minSpectateurs < 0 || minSpectateurs < previous.minSpectateurs))
+        return false;
+    if (previous.maxSpectateurs >= 0 && (maxSpectateurs < 0 || maxSpectateurs > previous.maxSpectateurs))
+        return false;
+    return setTighter(statuses, previous.statuses)
+           && setTighter(types, previous.types)
+           && setTighter(venues, previous.venues);
+}
+
+// MatchFilterEngine implementation
+void MatchFilterEngine::setMatches(const QVector<Match> &matches, quint64 version)
+{
+    m_rowCount = matches.size();
+    m_version = version;
+    m_ids.resize(m_rowCount);
+    m_days.resize(m_rowCount);
+    m_spectateurs.resize(m_rowCount);
+    m_statuses.resize(m_rowCount);
+    m_types.resize(m_rowCount);
+    m_venues.resize(m_rowCount);
+    m_rowById.clear();
+    m_rowById.reserve(m_rowCount);
+    m_statusBitmaps.clear();
+    m_typeBitmaps.clear();
+    m_venueBitmaps.clear();
+
+    // Extract typed columns once so evaluation never touches QVariant or QString
+    for (int row = 0; row < m_rowCount; ++row)
+        setRow(row, matches[row]);
+
+    m_hasPrevious = false;
+    m_previousRows.clear();
+}
+
+void MatchFilterEngine::setBit(QHash<QString, QBitArray> &bitmaps, const QString &value, int row)
+{
+    // Bitmaps grow to the table on demand; bits past their end read as clear
+    QBitArray &bitmap = bitmaps[value];
+    if (bitmap.size() <= row)
+        bitmap.resize(m_rowCount);
+    bitmap.setBit(row);
+}
+
+void MatchFilterEngine::clearBit(QHash<QString, QBitArray> &bitmaps, const QString &value, int row)
+{
+    auto it = bitmaps.find(value);
+    if (it == bitmaps.end() || row >= it->size())
+        return;
+    it->clearBit(row);
+    // A value nobody has any more leaves the filter lists
+    if (it->count(true) == 0)
+        bitmaps.erase(it);
+}
+
+bool MatchFilterEngine::hasBit(const QHash<QString, QBitArray> &bitmaps, const QSet<QString> &values, int row)
+{
+    for (const QString &value : values) {
+        auto it = bitmaps.constFind(value);
+        if (it != bitmaps.cend() && row < it->size() && it->testBit(row))
+            return true;
+    }
+    return false;
+}
+
+void MatchFilterEngine::setRow(int row, const Match &match)
+{
+    m_ids[row] = match.id;
+    m_rowById.insert(match.id, row);
+    m_days[row] = match.date.isValid() ? match.date.date().toJulianDay() : -1;
+    m_spectateurs[row] = match.spectateurs;
+    m_statuses[row] = match.status.trimmed();
+    m_types[row] = match.type.trimmed();
+    m_venues[row] = match.lieu.trimmed();
+    setBit(m_statusBitmaps, m_statuses[row], row);
+    setBit(m_typeBitmaps, m_types[row], row);
+    setBit(m_venueBitmaps, m_venues[row], row);
+}
+
+void MatchFilterEngine::clearRow(int row)
+{
+    clearBit(m_statusBitmaps, m_statuses[row], row);
+    clearBit(m_typeBitmaps, m_types[row], row);
+    clearBit(m_venueBitmaps, m_venues[row], row);
+}
+
+bool MatchFilterEngine::accepts(int row, const MatchFilterCriteria &criteria) const
+{
+    if (!criteria.statuses.isEmpty() && !hasBit(m_statusBitmaps, criteria.statuses, row))
+        return false;
+    if (!criteria.types.isEmpty() && !hasBit(m_typeBitmaps, criteria.types, row))
+        return false;
+    if (!criteria.venues.isEmpty() && !hasBit(m_venueBitmaps, criteria.venues, row))
+        return false;
+
+    const qint64 day = m_days[row];
+    if (criteria.from.isValid() && (day < 0 || day < criteria.from.toJulianDay()))
+        return false;
+    if (criteria.to.isValid() && (day < 0 || day > criteria.to.toJulianDay()))
+        return false;
+    const int spectateurs = m_spectateurs[row];
+    if (criteria.minSpectateurs >= 0 && (spectateurs < 0 || spectateurs < criteria.minSpectateurs))
+        return false;
+    if (criteria.maxSpectateurs >= 0 && (spectateurs < 0 || spectateurs > criteria.maxSpectateurs))
+        return false;
+    return true;
+}
+
+void MatchFilterEngine::setPrevious(int row, bool accepted)
+{
+    // The previous result stays in store order
+    auto it = std::lower_bound(m_previousRows.begin(), m_previousRows.end(), row);
+    const bool present = it != m_previousRows.end() && *it == row;
+    if (accepted && !present)
+        m_previousRows.insert(it, row);
+    else if (!accepted && present)
+        m_previousRows.erase(it);
+}
+
+void MatchFilterEngine::insertMatch(const Match &match, quint64 version)
+{
+    // The store appends new matches
+    const int row = m_rowCount++;
+    m_ids.resize(m_rowCount);
+    m_days.resize(m_rowCount);
+    m_spectateurs.resize(m_rowCount);
+    m_statuses.resize(m_rowCount);
+    m_types.resize(m_rowCount);
+    m_venues.resize(m_rowCount);
+    setRow(row, match);
+    if (m_hasPrevious && accepts(row, m_previousCriteria))
+        m_previousRows.append(row);
+    m_version = version;
+}
+
+void MatchFilterEngine::updateMatch(const Match &match, quint64 version)
+{
+    const int row = m_rowById.value(match.id, -1);
+    if (row < 0) {
+        insertMatch(match, version);
+        return;
+    }
+    clearRow(row);
+    setRow(row, match);
+    if (m_hasPrevious)
+        setPrevious(row, accepts(row, m_previousCriteria));
+    m_version = version;
+}
+
+void MatchFilterEngine::removeMatch(int id, quint64 version)
+{
+    const int row = m_rowById.value(id, -1);
+    if (row < 0) {
+        m_version = version;
+        return;
+    }
+
+    // Same swap-with-last as the store, so row numbers stay in step
+    const int last = m_rowCount - 1;
+    clearRow(row);
+    if (m_hasPrevious)
+        setPrevious(row, false);
+    if (row != last) {
+        const bool lastAccepted = m_hasPrevious && std::binary_search(m_previousRows.begin(), m_previousRows.end(), last);
+        m_ids[row] = m_ids[last];
+        m_rowById.insert(m_ids[row], row);
+        m_days[row] = m_days[last];
+        m_spectateurs[row] = m_spectateurs[last];
+        m_statuses[row] = m_statuses[last];
+        m_types[row] = m_types[last];
+        m_venues[row] = m_venues[last];
+        auto moveBit = [row, last](QHash<QString, QBitArray> &bitmaps, const QString &value) {
+            QBitArray &bitmap = bitmaps[value];
+            bitmap.clearBit(last);
+            bitmap.setBit(row);
+        };
+        moveBit(m_statusBitmaps, m_statuses[row]);
+        moveBit(m_typeBitmaps, m_types[row]);
+        moveBit(m_venueBitmaps, m_venues[row]);
+        if (m_hasPrevious) {
+            setPrevious(last, false);
+            setPrevious(row, lastAccepted);
+        }
+    }
+
+    m_rowById.remove(id);
+    m_rowCount = last;
+    m_ids.resize(m_rowCount);
+    m_days.resize(m_rowCount);
+    m_spectateurs.resize(m_rowCount);
+    m_statuses.resize(m_rowCount);
+    m_types.resize(m_rowCount);
+    m_venues.resize(m_rowCount);
+    m_version = version;
+}
+
+QStringList MatchFilterEngine::sortedKeys(const QHash<QString, QBitArray> &bitmaps)
+{
+    QStringList keys = bitmaps.keys();
+    keys.removeAll(QString());
+    std::sort(keys.begin(), keys.end(), [](const QString &a, const QString &b) {
+        return QString::localeAwareCompare(a, b) < 0;
+    });
+    return keys;
+}
+
+QBitArray MatchFilterEngine::categoricalMask(const QHash<QString, QBitArray> &bitmaps,
+                                             const QSet<QString> &values) const
+{
+    // Union of the bitmaps of the selected values
+    QBitArray mask(m_rowCount);
+    for (const QString &value : values) {
+        auto it = bitmaps.constFind(value);
+        if (it != bitmaps.cend())
+            mask |= it.value();
+    }
+    mask.resize(m_rowCount); // bitmaps may be shorter or longer than the table
+    return mask;
+}
+
+QVector<int> MatchFilterEngine::evaluate(const MatchFilterCriteria &criteria)
+{
+    bool incremental = m_hasPrevious && criteria.isTighterThan(m_previousCriteria);
+
+    // Intersect the categorical bitmaps first; they are word-at-a-time operations
+    QBitArray mask;
+    bool hasMask = false;
+    auto intersect = [&](const QHash<QString, QBitArray> &bitmaps, const QSet<QString> &values) {
+        if (values.isEmpty())
+            return;
+        QBitArray valuesMask = categoricalMask(bitmaps, values);
+        if (hasMask) {
+            mask &= valuesMask;
+        } else {
+            mask = valuesMask;
+            hasMask = true;
+        }
+    };
+    intersect(m_statusBitmaps, criteria.statuses);
+    intersect(m_typeBitmaps, criteria.types);
+    intersect(m_venueBitmaps, criteria.venues);
+
+    // Range checks compiled down to plain integer comparisons
+    const bool checkDays = criteria.from.isValid() || criteria.to.isValid();
+    const qint64 fromDay = criteria.from.isValid() ? criteria.from.toJulianDay() : std::numeric_limits<qint64>::min();
+    const qint64 toDay = criteria.to.isValid() ? criteria.to.toJulianDay() : std::numeric_limits<qint64>::max();
+    const bool checkSpectateurs = criteria.minSpectateurs >= 0 || criteria.maxSpectateurs >= 0;
+    const int minSpectateurs = criteria.minSpectateurs >= 0 ? criteria.minSpectateurs : 0;
+    const int maxSpectateurs = criteria.maxSpectateurs >= 0 ? criteria.maxSpectateurs : std::numeric_limits<int>::max();
+
+    auto accept = [&](int row) {
+        if (hasMask && !mask.testBit(row))
+            return false;
+        if (checkDays) {
+            qint64 day = m_days[row];
+            if (day < 0 || day < fromDay || day > toDay)
+                return false;
+        }
+        if (checkSpectateurs) {
+            int spectateurs = m_spectateurs[row];
+            if (spectateurs < 0 || spectateurs < minSpectateurs || spectateurs > maxSpectateurs)
+                return false;
+        }
+        return true;
+    };
+
+    QVector<int> rows;
+    if (incremental) {
+        // Tightened criteria can only drop rows from the previous result
+        rows.reserve(m_previousRows.size());
+        for (int row : std::as_const(m_previousRows)) {
+            if (accept(row))
+                rows.append(row);
+        }
+    } else {
+        for (int row = 0; row < m_rowCount; ++row) {
+            if (accept(row))
+                rows.append(row);
+        }
+    }
+
+    m_hasPrevious = true;
+    m_previousCriteria = criteria;
+    m_previousRows = rows;
+    return rows;
+}
+
+QSet<int> MatchFilterEngine::acceptedIds(const QVector<int> &rows) const
+{
+    QSet<int> ids;
+    ids.reserve(rows.size());
+    for (int row : rows)
+        ids.insert(m_ids[row]);
+    return ids;
+}
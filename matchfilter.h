@@ -0,0 +1,81 @@
+#ifndef MATCHFILTER_H
+#define MATCHFILTER_H
+
+#include <QBitArray>
+#include <QDate>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "matches.h"
+
+// Criteria from the filter panel. Empty sets and invalid bounds mean "any".
+struct MatchFilterCriteria
+{
+    QDate from;
+    QDate to;
+    int minSpectateurs = -1;
+    int maxSpectateurs = -1;
+    QSet<QString> statuses;
+    QSet<QString> types;
+    QSet<QString> venues;
+
+    bool isEmpty() const;
+    bool isTighterThan(const MatchFilterCriteria &previous) const; // every match kept by this is kept by previous
+};
+
+// Evaluates filter criteria over columns extracted once from the cached
+// matches. Categorical fields use one bitmap per distinct value; ranges are
+// checked on typed arrays. When criteria only get tighter, just the rows of
+// the previous result are re-checked. Single-row changes mirror the
+// MatchStore (appends, in-place updates, swap-with-last removals) and keep
+// the previous result, so narrowing still works after CRUD.
+class MatchFilterEngine
+{
+public:
+    void setMatches(const QVector<Match> &matches, quint64 version);
+    quint64 version() const { return m_version; }
+
+    // Same row moves as the MatchStore; version is the store's after the change
+    void insertMatch(const Match &match, quint64 version);
+    void updateMatch(const Match &match, quint64 version);
+    void removeMatch(int id, quint64 version);
+
+    QVector<int> evaluate(const MatchFilterCriteria &criteria); // matching rows, in store order
+    QSet<int> acceptedIds(const QVector<int> &rows) const;
+
+    QStringList statuses() const { return sortedKeys(m_statusBitmaps); }
+    QStringList types() const { return sortedKeys(m_typeBitmaps); }
+    QStringList venues() const { return sortedKeys(m_venueBitmaps); }
+
+private:
+    static QStringList sortedKeys(const QHash<QString, QBitArray> &bitmaps);
+    void setBit(QHash<QString, QBitArray> &bitmaps, const QString &value, int row);
+    static void clearBit(QHash<QString, QBitArray> &bitmaps, const QString &value, int row);
+    static bool hasBit(const QHash<QString, QBitArray> &bitmaps, const QSet<QString> &values, int row);
+    QBitArray categoricalMask(const QHash<QString, QBitArray> &bitmaps, const QSet<QString> &values) const;
+    void setRow(int row, const Match &match);
+    void clearRow(int row);
+    bool accepts(int row, const MatchFilterCriteria &criteria) const; // one row, for the previous result
+    void setPrevious(int row, bool accepted);
+
+    int m_rowCount = 0;
+    quint64 m_version = 0;
+    QVector<int> m_ids;
+    QHash<int, int> m_rowById;
+    QVector<QString> m_statuses;   // trimmed bitmap keys per row, to clear them later
+    QVector<QString> m_types;
+    QVector<QString> m_venues;
+    QVector<qint64> m_days;        // Julian day, or -1 when the date is missing
+    QVector<int> m_spectateurs;    // -1 when not numeric
+    QHash<QString, QBitArray> m_statusBitmaps;
+    QHash<QString, QBitArray> m_typeBitmaps;
+    QHash<QString, QBitArray> m_venueBitmaps;
+
+    bool m_hasPrevious = false;
+    MatchFilterCriteria m_previousCriteria;
+    QVector<int> m_previousRows;
+};
+
+#endif // MATCHFILTER_H
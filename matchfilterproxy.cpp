@@ -0,0 +1,238 @@
+#include "matchfilterproxy.h"
+#include <QTimer>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+MatchFilterProxy::MatchFilterProxy(QObject *parent)
+    : QSortFilterProxyModel(parent), m_searchActive(false), m_criteriaActive(false), m_rankOrder(false),
+      m_store(nullptr), m_sortRefreshPending(false)
+{
+}
+
+MatchFilterProxy::ViewState MatchFilterProxy::viewState() const
+{
+    // Implicitly shared containers: cheap to take on the GUI thread
+    ViewState state;
+    state.searchActive = m_searchActive;
+    state.searchScores = m_searchScores;
+    state.rankOrder = m_rankOrder;
+    state.criteriaActive = m_criteriaActive;
+    state.criteriaIds = m_criteriaIds;
+    state.sortSpec = m_sortSpec;
+    state.sortKeys = m_sortKeys;
+    return state;
+}
+
+QVector<int> MatchFilterProxy::ViewState::order(const QVector<Match> &matches, quint64 version) const
+{
+    const bool ranked = rankOrder && searchActive;
+    QVector<int> rows;
+    if (!sortSpec.isEmpty() && !ranked) {
+        MatchSortKeys keys = sortKeys;
+        if (!keys.isBuilt() || keys.version() != version)
+            keys.build(matches, version);
+        rows = keys.order(sortSpec);
+    } else {
+        rows.resize(matches.size());
+        std::iota(rows.begin(), rows.end(), 0);
+    }
+
+    // Same tests as filterAcceptsRow()
+    rows.erase(std::remove_if(rows.begin(), rows.end(), [&](int row) {
+        const int id = matches[row].id;
+        return (searchActive && !searchScores.contains(id)) || (criteriaActive && !criteriaIds.contains(id));
+    }), rows.end());
+
+    if (ranked) {
+        std::stable_sort(rows.begin(), rows.end(), [&](int a, int b) {
+            return searchScores.value(matches[a].id) > searchScores.value(matches[b].id);
+        });
+    }
+    return rows;
+}
+
+void MatchFilterProxy::setMatchStore(const MatchStore *store)
+{
+    m_store = store;
+    connect(store, &MatchStore::reloaded, this, &MatchFilterProxy::scheduleSortRefresh);
+    connect(store, &MatchStore::matchInserted, this, &MatchFilterProxy::scheduleSortRefresh);
+    connect(store, &MatchStore::matchUpdated, this, &MatchFilterProxy::scheduleSortRefresh);
+    connect(store, &MatchStore::matchRemoved, this, &MatchFilterProxy::scheduleSortRefresh);
+}
+
+void MatchFilterProxy::setSourceModel(QAbstractItemModel *model)
+{
+    // Source rows move on select() and grow on fetchMore(). Connect before the
+    // base class so positions are current when it re-sorts on the same signals.
+    connect(model, &QAbstractItemModel::modelReset, this, &MatchFilterProxy::refreshSortRanks);
+    connect(model, &QAbstractItemModel::rowsInserted, this, &MatchFilterProxy::extendSortRanks);
+    connect(model, &QAbstractItemModel::rowsRemoved, this, &MatchFilterProxy::refreshSortRanks);
+    QSortFilterProxyModel::setSourceModel(model);
+}
+
+void MatchFilterProxy::scheduleSortRefresh()
+{
+    // Coalesce bursts of store changes into one re-sort
+    if (m_sortRefreshPending)
+        return;
+    m_sortRefreshPending = true;
+    QTimer::singleShot(0, this, [this]() {
+        m_sortRefreshPending = false;
+        computeSortRanks();
+        if (!m_sortSpec.isEmpty() && !m_rankOrder)
+            invalidate();
+    });
+}
+
+void MatchFilterProxy::computeSortRanks()
+{
+    m_positionById.clear();
+    m_rowPosition.clear();
+    if (!m_store || m_sortSpec.isEmpty())
+        return;
+
+    if (!m_sortKeys.isBuilt() || m_sortKeys.version() != m_store->version())
+        m_sortKeys.build(m_store->matches(), m_store->version());
+
+    const QVector<int> permutation = m_sortKeys.order(m_sortSpec);
+    m_positionById.reserve(permutation.size());
+    for (int position = 0; position < permutation.size(); ++position)
+        m_positionById.insert(m_sortKeys.idAt(permutation[position]), position);
+
+    refreshSortRanks();
+}
+
+void MatchFilterProxy::refreshSortRanks()
+{
+    // One pass over the source rows maps each to its precomputed position
+    m_rowPosition.clear();
+    if (m_positionById.isEmpty() || !sourceModel())
+        return;
+    extendSortRanks(QModelIndex(), 0, sourceModel()->rowCount() - 1);
+}
+
+void MatchFilterProxy::extendSortRanks(const QModelIndex &parent, int first, int last)
+{
+    Q_UNUSED(parent);
+    if (m_positionById.isEmpty())
+        return;
+    if (first != m_rowPosition.size()) {
+        // Rows inserted in the middle shift everything after them
+        first = 0;
+        last = sourceModel()->rowCount() - 1;
+        m_rowPosition.clear();
+    }
+
+    // Rows missing from the store (not yet synced) sort after the known ones
+    const int unknown = std::numeric_limits<int>::max() / 2;
+    m_rowPosition.reserve(last + 1);
+    for (int row = first; row <= last; ++row)
+        m_rowPosition.append(m_positionById.value(idForRow(row), unknown + row));
+}
+
+int MatchFilterProxy::idForRow(int sourceRow) const
+{
+    return sourceModel()->index(sourceRow, 0).data().toInt();
+}
+
+void MatchFilterProxy::setSearchResults(const QHash<int, double> &scores)
+{
+    m_searchScores = scores;
+    m_searchActive = true;
+    invalidateFilter();
+}
+
+void MatchFilterProxy::clearSearch()
+{
+    if (!m_searchActive)
+        return;
+    m_searchScores.clear();
+    m_searchActive = false;
+    m_rankOrder = false;
+    invalidateFilter();
+}
+
+void MatchFilterProxy::setCriteriaFilter(const QSet<int> &ids)
+{
+    m_criteriaIds = ids;
+    m_criteriaActive = true;
+    invalidateFilter();
+}
+
+void MatchFilterProxy::clearCriteriaFilter()
+{
+    if (!m_criteriaActive)
+        return;
+    m_criteriaIds.clear();
+    m_criteriaActive = false;
+    invalidateFilter();
+}
+
+void MatchFilterProxy::sortByRank()
+{
+    m_rankOrder = true;
+    // The base class skips sorting when column and order are unchanged
+    if (sortColumn() == 0 && sortOrder() == Qt::AscendingOrder)
+        invalidate();
+    else
+        QSortFilterProxyModel::sort(0, Qt::AscendingOrder);
+}
+
+void MatchFilterProxy::sort(int column, Qt::SortOrder order)
+{
+    // Any explicit column sort (header click, sort buttons) ends rank order
+    m_rankOrder = false;
+
+    if (column >= 0) {
+        // The clicked column becomes the primary key, earlier ones break ties
+        MatchSortKeys::SortSpec spec;
+        spec.append(qMakePair(column, order));
+        for (const auto &key : std::as_const(m_sortSpec)) {
+            if (key.first != column && spec.size() < 3)
+                spec.append(key);
+        }
+        m_sortSpec = spec;
+    } else {
+        m_sortSpec.clear();
+    }
+    computeSortRanks();
+
+    if (sortColumn() == column && sortOrder() == order)
+        invalidate();
+    else
+        QSortFilterProxyModel::sort(column, order);
+}
+
+bool MatchFilterProxy::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    Q_UNUSED(sourceParent);
+    if (!m_searchActive && !m_criteriaActive)
+        return true;
+
+    int id = idForRow(sourceRow);
+    if (m_searchActive && !m_searchScores.contains(id))
+        return false;
+    if (m_criteriaActive && !m_criteriaIds.contains(id))
+        return false;
+    return true;
+}
+
+bool MatchFilterProxy::lessThan(const QModelIndex &left, const QModelIndex &right) const
+{
+    if (m_rankOrder && m_searchActive) {
+        double leftScore = m_searchScores.value(idForRow(left.row()));
+        double rightScore = m_searchScores.value(idForRow(right.row()));
+        return leftScore > rightScore;
+    }
+
+    int leftRow = left.row();
+    int rightRow = right.row();
+    if (leftRow < m_rowPosition.size() && rightRow < m_rowPosition.size()) {
+        // Positions already encode the sort order; undo the base class reversal
+        bool before = m_rowPosition[leftRow] < m_rowPosition[rightRow];
+        bool after = m_rowPosition[leftRow] > m_rowPosition[rightRow];
+        return sortOrder() == Qt::AscendingOrder ? before : after;
+    }
+    return QSortFilterProxyModel::lessThan(left, right);
+}
@@ -0,0 +1,82 @@
+#ifndef MATCHFILTERPROXY_H
+#define MATCHFILTERPROXY_H
+
+#include <QSortFilterProxyModel>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include "matches.h"
+#include "matchsort.h"
+
+// Proxy for the MATCHES table that filters and ranks rows by match ID
+// (column 0) instead of scanning cell text.
+class MatchFilterProxy : public QSortFilterProxyModel
+{
+    Q_OBJECT
+public:
+    // The filters and sort of the view as plain data, so that a worker
+    // thread can rebuild the view order from a store snapshot without
+    // walking (or fetching) the SQL model
+    struct ViewState
+    {
+        bool searchActive = false;
+        QHash<int, double> searchScores;
+        bool rankOrder = false;
+        bool criteriaActive = false;
+        QSet<int> criteriaIds;
+        MatchSortKeys::SortSpec sortSpec; // empty: store order (by ID)
+        MatchSortKeys sortKeys;           // rebuilt when stale for the snapshot
+
+        // Store rows in view order; rows not yet synced into the store are absent
+        QVector<int> order(const QVector<Match> &matches, quint64 version) const;
+    };
+
+    explicit MatchFilterProxy(QObject *parent = nullptr);
+
+    ViewState viewState() const;
+
+    // Only rows whose ID has a score are shown; higher scores rank first
+    void setSearchResults(const QHash<int, double> &scores);
+    void clearSearch();
+    bool isSearchActive() const { return m_searchActive; }
+
+    // Rows must also be in this ID set while a criteria filter is set
+    void setCriteriaFilter(const QSet<int> &ids);
+    void clearCriteriaFilter();
+
+    // Column sorts use typed keys from the store instead of QVariant compares
+    void setMatchStore(const MatchStore *store);
+    void setSourceModel(QAbstractItemModel *model) override;
+
+    // Orders rows by search score until the next column sort
+    void sortByRank();
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+    bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
+
+private slots:
+    void scheduleSortRefresh();
+    void refreshSortRanks();
+    void extendSortRanks(const QModelIndex &parent, int first, int last);
+
+private:
+    int idForRow(int sourceRow) const;
+    void computeSortRanks();
+
+    QHash<int, double> m_searchScores;
+    bool m_searchActive;
+    QSet<int> m_criteriaIds;
+    bool m_criteriaActive;
+    bool m_rankOrder;
+
+    const MatchStore *m_store;
+    MatchSortKeys m_sortKeys;
+    MatchSortKeys::SortSpec m_sortSpec;  // primary column first, previous columns as tie-breakers
+    QHash<int, int> m_positionById;      // match ID -> position in the typed sort
+    QVector<int> m_rowPosition;          // source row -> position, compared in lessThan
+    bool m_sortRefreshPending;
+};
+
+#endif // MATCHFILTERPROXY_H
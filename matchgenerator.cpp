@@ -0,0 +1,184 @@
+#include "matchgenerator.h"
+#include "queryprofiler.h"
+#include <QSqlError>
+#include <QtMath>
+#include <algorithm>
+
+namespace {
+
+struct Venue
+{
+    const char *name;
+    int capacity;
+};
+
+// A few big stadiums and many small grounds, like the real fixture list
+const Venue venues[] = {
+    {"Stade Olympique", 60000}, {"Stade Municipal", 22000}, {"Stade de la Ville", 18000},
+    {"Parc des Sports", 15000}, {"Stade du Port", 12000}, {"Stade Universitaire", 8000},
+    {"Stade des Oliviers", 6500}, {"Complexe Sportif Nord", 5000}, {"Stade du Lac", 4500},
+    {"Stade de la Gare", 3500}, {"Terrain Annexe", 2000}, {"Stade des Jeunes", 1500},
+    {"Stade Communal Sud", 1200}, {"Terrain du Centre", 800}, {"Stade de Quartier", 600},
+    {"Terrain Synthétique Est", 400}
+};
+const int venueCount = int(sizeof(venues) / sizeof(venues[0]));
+
+// Share of the fixtures and typical fill rate per type
+struct TypeProfile
+{
+    const char *name;
+    int weight;
+    double fill;
+};
+const TypeProfile types[] = {
+    {"championnat", 70, 0.55}, {"compétitif", 20, 0.75}, {"amicale", 10, 0.25}
+};
+
+const int kickoffHours[] = {14, 15, 16, 18, 19, 20, 21};
+
+} // namespace
+
+MatchGenerator::MatchGenerator(quint32 seed)
+    : m_random(seed)
+{
+}
+
+int MatchGenerator::poisson(double mean)
+{
+    // Knuth's method is fine for goal counts
+    const double limit = qExp(-mean);
+    double product = m_random.generateDouble();
+    int count = 0;
+    while (product > limit) {
+        product *= m_random.generateDouble();
+        count++;
+    }
+    return count;
+}
+
+QVector<Match> MatchGenerator::generate(int count, const QDate &today)
+{
+    QVector<Match> matches;
+    if (count <= 0)
+        return matches;
+    matches.reserve(count);
+
+    // About twenty matches on an average day; the last tenth is still to come
+    const int span = qMax(365, count / 20);
+    const QDate first = today.addDays(-span * 9 / 10);
+
+    QVector<qint64> kickoffs;
+    kickoffs.reserve(count);
+    while (kickoffs.size() < count) {
+        const QDate day = first.addDays(m_random.bounded(span));
+        // Weekends carry most of the fixtures
+        if (day.dayOfWeek() < 6 && m_random.bounded(4) != 0)
+            continue;
+        const int hour = kickoffHours[m_random.bounded(int(sizeof(kickoffHours) / sizeof(kickoffHours[0])))];
+        kickoffs.append(QDateTime(day, QTime(hour, m_random.bounded(2) * 30)).toMSecsSinceEpoch());
+    }
+    std::sort(kickoffs.begin(), kickoffs.end());
+
+    const QDateTime now(today, QTime(0, 0));
+    for (int i = 0; i < count; ++i) {
+        Match match;
+        match.id = i + 1;
+        match.date = QDateTime::fromMSecsSinceEpoch(kickoffs[i]);
+
+        // Small grounds are far more common than big stadiums
+        const Venue &venue = venues[qMin(venueCount - 1, int(venueCount * qPow(m_random.generateDouble(), 1.6)))];
+        match.lieu = QString::fromUtf8(venue.name);
+
+        int pick = m_random.bounded(100);
+        const TypeProfile *type = &types[0];
+        for (const TypeProfile &profile : types) {
+            if (pick < profile.weight) {
+                type = &profile;
+                break;
+            }
+            pick -= profile.weight;
+        }
+        match.type = QString::fromUtf8(type->name);
+
+        if (match.date >= now) {
+            match.status = QString::fromUtf8("programmé");
+        } else {
+            const int outcome = m_random.bounded(100);
+            if (outcome < 2) {
+                match.status = QString::fromUtf8("annulé");
+            } else if (outcome < 4) {
+                match.status = QString::fromUtf8("reporté");
+            } else {
+                match.status = QString::fromUtf8("terminé");
+                match.score = QString("%1-%2").arg(poisson(1.45)).arg(poisson(1.15));
+
+                const int missing = m_random.bounded(1000);
+                if (missing < 30) {
+                    // Not counted at the gate
+                } else if (missing < 35) {
+                    match.spectateursText = "N/A";
+                } else {
+                    const double fill = qBound(0.02, type->fill + (m_random.generateDouble() - 0.5) * 0.5, 1.0);
+                    match.spectateurs = int(venue.capacity * fill);
+                    match.spectateursText = QString::number(match.spectateurs);
+                }
+            }
+        }
+        matches.append(match);
+    }
+    return matches;
+}
+
+bool MatchGenerator::createSchema(QSqlDatabase db, QString *error)
+{
+    // Column types follow the Oracle table; IDMATCH is assigned on insert
+    const char *statements[] = {
+        "DROP TABLE IF EXISTS MATCHES",
+        "CREATE TABLE MATCHES (IDMATCH INTEGER PRIMARY KEY, DATEMATCH TIMESTAMP, LIEU VARCHAR(100), "
+        "STATUS VARCHAR(50), SCORE VARCHAR(20), TYPEMATCH VARCHAR(50), SPECTATEURS VARCHAR(20))",
+        "CREATE INDEX MATCHES_DATEMATCH ON MATCHES (DATEMATCH)"
+    };
+    for (const char *sql : statements) {
+        ProfiledQuery query("Generator schema", db);
+        if (!query.exec(QString::fromLatin1(sql))) {
+            if (error)
+                *error = query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MatchGenerator::insert(QSqlDatabase db, const QVector<Match> &matches, QString *error)
+{
+    if (!db.transaction()) {
+        if (error)
+            *error = "Cannot start a transaction: " + db.lastError().text();
+        return false;
+    }
+
+    ProfiledQuery query("Generator insert", db);
+    query.prepare(QString::fromLatin1(MatchStore::insertColumns()));
+    for (const Match &match : matches) {
+        query.bindValue(0, match.date);
+        query.bindValue(1, match.lieu);
+        query.bindValue(2, match.status);
+        query.bindValue(3, match.score);
+        query.bindValue(4, match.type);
+        query.bindValue(5, match.spectateursText);
+        if (!query.exec()) {
+            if (error)
+                *error = QString("Insert of match %1 failed: %2").arg(match.id).arg(query.lastError().text());
+            db.rollback();
+            return false;
+        }
+    }
+
+    if (!db.commit()) {
+        if (error)
+            *error = "Commit failed: " + db.lastError().text();
+        db.rollback();
+        return false;
+    }
+    return true;
+}
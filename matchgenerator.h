@@ -0,0 +1,35 @@
+#ifndef MATCHGENERATOR_H
+#define MATCHGENERATOR_H
+
+#include <QDate>
+#include <QRandomGenerator>
+#include <QSqlDatabase>
+#include <QString>
+#include <QVector>
+#include "matches.h"
+
+// Synthetic MATCHES data for benchmarks and local runs. Matches are spread
+// over the calendar with busy weekends, played ones get a score and an
+// attendance that depends on the venue and the match type, upcoming ones
+// get neither, and a few attendances are missing or not numeric, as in the
+// real table. The same seed always gives the same matches.
+class MatchGenerator
+{
+public:
+    explicit MatchGenerator(quint32 seed);
+
+    // Chronological, with IDs 1..count; matches before today are played
+    QVector<Match> generate(int count, const QDate &today = QDate::currentDate());
+
+    // A local SQLite stand-in for the MATCHES table (replaces any existing one)
+    static bool createSchema(QSqlDatabase db, QString *error = nullptr);
+    // Same INSERT as the CSV import, in one transaction
+    static bool insert(QSqlDatabase db, const QVector<Match> &matches, QString *error = nullptr);
+
+private:
+    int poisson(double mean);
+
+    QRandomGenerator m_random;
+};
+
+#endif // MATCHGENERATOR_H
@@ -0,0 +1,44 @@
+#include "matchsimulation.h"
+#include <QStringList>
+#include <algorithm>
+
+namespace MatchSimulation {
+
+bool parseScore(const QString &score, int *home, int *away)
+{
+    *home = 0;
+    *away = 0;
+
+    // Split the score string "2-2" into home and away scores
+    QStringList scores = score.split("-");
+    if (scores.size() != 2)
+        return false;
+
+    bool homeOk = false;
+    bool awayOk = false;
+    *home = scores[0].trimmed().toInt(&homeOk);
+    *away = scores[1].trimmed().toInt(&awayOk);
+    return homeOk && awayOk;
+}
+
+QList<int> planGoalTimes(int goals, QRandomGenerator *generator)
+{
+    QList<int> times;
+    for (int i = 0; i < goals; i++) {
+        // Distribute goals throughout the match, some in first half, some in second
+        int goalTime;
+        if (i < goals / 2) {
+            // First half goals (1-45 seconds)
+            goalTime = generator->bounded(5, 44);
+        } else {
+            // Second half goals (46-90 seconds)
+            goalTime = generator->bounded(46, 89);
+        }
+        times.append(goalTime);
+    }
+    // Sort goal times in ascending order
+    std::sort(times.begin(), times.end());
+    return times;
+}
+
+} // namespace MatchSimulation
@@ -0,0 +1,21 @@
+#ifndef MATCHSIMULATION_H
+#define MATCHSIMULATION_H
+
+#include <QList>
+#include <QRandomGenerator>
+#include <QString>
+
+// Match simulation rules shared by the animated simulation and the headless
+// command line. The match lasts 90 "minutes" (seconds in the animation).
+namespace MatchSimulation {
+
+// Parses a "2-1" score; returns false (and 0-0) when it is not of that form
+bool parseScore(const QString &score, int *home, int *away);
+
+// Plans when the goals are scored: the first half of the goals fall in the
+// first half of the match, the rest in the second. Sorted ascending.
+QList<int> planGoalTimes(int goals, QRandomGenerator *generator = QRandomGenerator::global());
+
+} // namespace MatchSimulation
+
+#endif // MATCHSIMULATION_H
@@ -0,0 +1,117 @@
+#include "matchsort.h"
+#include <QCollator>
+#include <QThread>
+#include <QtConcurrent>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+void MatchSortKeys::build(const QVector<Match> &matches, quint64 version)
+{
+    const int rowCount = matches.size();
+    m_ids.resize(rowCount);
+    m_dates.resize(rowCount);
+    m_spectateurs.resize(rowCount);
+
+    for (int row = 0; row < rowCount; ++row) {
+        const Match &match = matches[row];
+        m_ids[row] = match.id;
+        m_dates[row] = match.date.isValid() ? match.date.toMSecsSinceEpoch()
+                                            : std::numeric_limits<qint64>::min();
+        m_spectateurs[row] = match.spectateurs;
+    }
+
+    // Collation keys are the expensive part; build one text column per thread.
+    // QCollator is not thread-safe, so each column gets its own.
+    QVector<int> textColumns = {0, 1, 2, 3};
+    QtConcurrent::blockingMap(textColumns, [this, &matches, rowCount](int column) {
+        QCollator collator;
+        collator.setCaseSensitivity(Qt::CaseInsensitive);
+        collator.setNumericMode(true);
+
+        QVector<QCollatorSortKey> keys;
+        keys.reserve(rowCount);
+        for (const Match &match : matches) {
+            const QString &text = column == 0 ? match.lieu
+                                : column == 1 ? match.status
+                                : column == 2 ? match.score
+                                              : match.type;
+            keys.append(collator.sortKey(text));
+        }
+        m_text[column] = keys;
+    });
+
+    m_version = version;
+    m_built = true;
+}
+
+int MatchSortKeys::compare(int column, int a, int b) const
+{
+    switch (column) {
+    case 0:
+        return m_ids[a] < m_ids[b] ? -1 : (m_ids[a] > m_ids[b] ? 1 : 0);
+    case 1:
+        return m_dates[a] < m_dates[b] ? -1 : (m_dates[a] > m_dates[b] ? 1 : 0);
+    case 2:
+        return m_text[0][a].compare(m_text[0][b]);
+    case 3:
+        return m_text[1][a].compare(m_text[1][b]);
+    case 4:
+        return m_text[2][a].compare(m_text[2][b]);
+    case 5:
+        return m_text[3][a].compare(m_text[3][b]);
+    case 6:
+        return m_spectateurs[a] < m_spectateurs[b] ? -1 : (m_spectateurs[a] > m_spectateurs[b] ? 1 : 0);
+    default:
+        return 0;
+    }
+}
+
+QVector<int> MatchSortKeys::order(const SortSpec &spec) const
+{
+    const int rowCount = m_ids.size();
+    QVector<int> permutation(rowCount);
+    std::iota(permutation.begin(), permutation.end(), 0);
+    if (spec.isEmpty() || rowCount < 2)
+        return permutation;
+
+    auto lessThan = [this, &spec](int a, int b) {
+        for (const auto &key : spec) {
+            int result = compare(key.first, a, b);
+            if (result != 0)
+                return key.second == Qt::AscendingOrder ? result < 0 : result > 0;
+        }
+        return false;
+    };
+
+    // Small tables are faster on one core
+    const int threads = QThread::idealThreadCount();
+    if (rowCount < 20000 || threads < 2) {
+        std::stable_sort(permutation.begin(), permutation.end(), lessThan);
+        return permutation;
+    }
+
+    // Stable-sort one run per core...
+    const int runLength = (rowCount + threads - 1) / threads;
+    QVector<QPair<int, int>> runs;
+    for (int begin = 0; begin < rowCount; begin += runLength)
+        runs.append(qMakePair(begin, qMin(begin + runLength, rowCount)));
+
+    int *data = permutation.data();
+    QtConcurrent::blockingMap(runs, [data, &lessThan](const QPair<int, int> &run) {
+        std::stable_sort(data + run.first, data + run.second, lessThan);
+    });
+
+    // ...then merge neighbouring runs pairwise; inplace_merge keeps equal keys in order
+    for (int width = runLength; width < rowCount; width *= 2) {
+        QVector<QPair<int, int>> merges; // (begin, middle); end is begin + 2 * width
+        for (int begin = 0; begin + width < rowCount; begin += 2 * width)
+            merges.append(qMakePair(begin, begin + width));
+
+        QtConcurrent::blockingMap(merges, [data, width, rowCount, &lessThan](const QPair<int, int> &merge) {
+            int end = qMin(merge.first + 2 * width, rowCount);
+            std::inplace_merge(data + merge.first, data + merge.second, data + end, lessThan);
+        });
+    }
+    return permutation;
+}
@@ -0,0 +1,38 @@
+#ifndef MATCHSORT_H
+#define MATCHSORT_H
+
+#include <QCollatorSortKey>
+#include <QList>
+#include <QPair>
+#include <QVector>
+#include "matches.h"
+
+// Sort keys extracted once from the cached matches: dates as int64,
+// spectators as int32 and collation keys for the text columns. Column
+// numbers follow the MATCHES table model (0 = ID ... 6 = Spectateurs).
+class MatchSortKeys
+{
+public:
+    using SortSpec = QList<QPair<int, Qt::SortOrder>>; // primary key first
+
+    void build(const QVector<Match> &matches, quint64 version);
+    quint64 version() const { return m_version; }
+    bool isBuilt() const { return m_built; }
+    int size() const { return m_ids.size(); }
+    int idAt(int row) const { return m_ids[row]; }
+
+    // Stable multi-column sort of the store rows, chunks sorted in parallel then merged
+    QVector<int> order(const SortSpec &spec) const;
+
+private:
+    int compare(int column, int a, int b) const;
+
+    bool m_built = false;
+    quint64 m_version = 0;
+    QVector<int> m_ids;
+    QVector<qint64> m_dates;       // msecs since epoch, minimum when missing
+    QVector<qint32> m_spectateurs; // -1 when not numeric
+    QVector<QCollatorSortKey> m_text[4]; // LIEU, STATUS, SCORE, TYPEMATCH
+};
+
+#endif // MATCHSORT_H
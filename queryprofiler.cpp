@@ -0,0 +1,356 @@
+#include "queryprofiler.h"
+#include "trace.h"
+#include <QDebug>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QMutexLocker>
+#include <QSqlRecord>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <cmath>
+
+// LatencyHistogram implementation
+int LatencyHistogram::bucketFor(qint64 micros)
+{
+    if (micros <= 0)
+        return 0;
+    int bucket = int(std::floor(std::log2(double(micros)) * 4.0)) + 1;
+    return qBound(1, bucket, BucketCount - 1);
+}
+
+qint64 LatencyHistogram::bucketMidpoint(int bucket)
+{
+    if (bucket <= 0)
+        return 0;
+    // Geometric middle of [2^((b-1)/4), 2^(b/4))
+    return qint64(std::pow(2.0, (bucket - 0.5) / 4.0));
+}
+
+void LatencyHistogram::add(qint64 micros)
+{
+    if (m_count == 0) {
+        m_min = micros;
+        m_max = micros;
+    } else {
+        m_min = qMin(m_min, micros);
+        m_max = qMax(m_max, micros);
+    }
+    m_buckets[bucketFor(micros)]++;
+    m_count++;
+}
+
+qint64 LatencyHistogram::percentile(double p) const
+{
+    if (m_count == 0)
+        return 0;
+
+    qint64 rank = qMax<qint64>(1, qint64(std::ceil(p * m_count)));
+    qint64 seen = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        seen += m_buckets[i];
+        if (seen >= rank)
+            return qBound(m_min, bucketMidpoint(i), m_max);
+    }
+    return m_max;
+}
+
+// QueryProfiler implementation
+QueryProfiler &QueryProfiler::instance()
+{
+    static QueryProfiler profiler;
+    return profiler;
+}
+
+QueryProfiler::QueryProfiler()
+    : m_slowThresholdMs(200)
+{
+    // Threshold can be tuned per deployment without rebuilding
+    bool ok = false;
+    int envThreshold = qEnvironmentVariableIntValue("PROBALL_SLOW_QUERY_MS", &ok);
+    if (ok && envThreshold >= 0)
+        m_slowThresholdMs = envThreshold;
+
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+    if (dir.isEmpty())
+        dir = QDir::currentPath();
+    QDir().mkpath(dir);
+    m_slowLogPath = QDir(dir).filePath("slow_queries.log");
+}
+
+void QueryProfiler::record(const QString &label, const QString &sql,
+                           qint64 prepareMicros, qint64 execMicros, qint64 fetchMicros,
+                           qint64 rows, qint64 bytes, bool ok)
+{
+    qint64 total = prepareMicros + execMicros + fetchMicros;
+    int threshold;
+    {
+        QMutexLocker locker(&m_mutex);
+        QueryStatementStats &stats = m_stats[label];
+        stats.label = label;
+        if (!sql.isEmpty())
+            stats.sql = sql;
+        stats.executions++;
+        if (!ok)
+            stats.failures++;
+        stats.prepareMicros += prepareMicros;
+        stats.execMicros += execMicros;
+        stats.fetchMicros += fetchMicros;
+        stats.rows += rows;
+        stats.bytes += bytes;
+        stats.latency.add(total);
+        threshold = m_slowThresholdMs;
+    }
+
+    if (total >= qint64(threshold) * 1000)
+        appendSlowQuery(label, sql, prepareMicros, execMicros, fetchMicros, rows, bytes);
+}
+
+QList<QueryStatementStats> QueryProfiler::snapshot() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stats.values();
+}
+
+void QueryProfiler::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    m_stats.clear();
+}
+
+int QueryProfiler::slowQueryThresholdMs() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_slowThresholdMs;
+}
+
+void QueryProfiler::setSlowQueryThresholdMs(int ms)
+{
+    QMutexLocker locker(&m_mutex);
+    m_slowThresholdMs = qMax(0, ms);
+}
+
+QString QueryProfiler::slowQueryLogPath() const
+{
+    return m_slowLogPath;
+}
+
+void QueryProfiler::appendSlowQuery(const QString &label, const QString &sql,
+                                    qint64 prepareMicros, qint64 execMicros, qint64 fetchMicros,
+                                    qint64 rows, qint64 bytes)
+{
+    // Serialise writers so lines from different threads don't interleave
+    static QMutex fileMutex;
+    QMutexLocker locker(&fileMutex);
+
+    QFile file(m_slowLogPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        qDebug() << "Cannot open slow query log:" << file.errorString();
+        return;
+    }
+
+    QString flatSql = sql.simplified();
+    QTextStream out(&file);
+    out << QDateTime::currentDateTime().toString(Qt::ISODateWithMs) << '\t'
+        << label << '\t'
+        << "total_ms=" << QString::number((prepareMicros + execMicros + fetchMicros) / 1000.0, 'f', 3) << '\t'
+        << "prepare_ms=" << QString::number(prepareMicros / 1000.0, 'f', 3) << '\t'
+        << "exec_ms=" << QString::number(execMicros / 1000.0, 'f', 3) << '\t'
+        << "fetch_ms=" << QString::number(fetchMicros / 1000.0, 'f', 3) << '\t'
+        << "rows=" << rows << '\t'
+        << "bytes=" << bytes << '\t'
+        << flatSql << '\n';
+}
+
+// ProfiledQuery implementation
+namespace {
+qint64 variantBytes(const QVariant &value)
+{
+    if (value.isNull())
+        return 0;
+    switch (value.typeId()) {
+    case QMetaType::QString:
+        return qint64(value.toString().size()) * qint64(sizeof(QChar));
+    case QMetaType::QByteArray:
+        return value.toByteArray().size();
+    default:
+        return value.metaType().sizeOf();
+    }
+}
+}
+
+ProfiledQuery::ProfiledQuery(const QString &label, const QSqlDatabase &db)
+    : m_label(label), m_query(db)
+{
+}
+
+ProfiledQuery::~ProfiledQuery()
+{
+    finish();
+}
+
+bool ProfiledQuery::prepare(const QString &sql)
+{
+    finish();
+    m_sql = sql;
+    PB_TRACE_SCOPE_DETAIL("sql.prepare", m_label);
+    QElapsedTimer timer;
+    timer.start();
+    bool ok = m_query.prepare(sql);
+    m_prepareNanos = timer.nsecsElapsed();
+    if (!ok) {
+        // A failed prepare never reaches exec(), record it on its own
+        m_ok = false;
+        m_pending = true;
+        finish();
+    }
+    return ok;
+}
+
+void ProfiledQuery::bindValue(int pos, const QVariant &value)
+{
+    m_query.bindValue(pos, value);
+}
+
+void ProfiledQuery::bindValue(const QString &placeholder, const QVariant &value)
+{
+    m_query.bindValue(placeholder, value);
+}
+
+void ProfiledQuery::addBindValue(const QVariant &value)
+{
+    m_query.addBindValue(value);
+}
+
+void ProfiledQuery::startSample()
+{
+    // Keep the prepare cost on the first exec after prepare() only
+    m_execNanos = 0;
+    m_fetchNanos = 0;
+    m_rows = 0;
+    m_bytes = 0;
+    m_pending = true;
+}
+
+bool ProfiledQuery::exec()
+{
+    if (m_pending)
+        finish();
+    startSample();
+    PB_TRACE_SCOPE_DETAIL("sql.exec", m_label);
+    QElapsedTimer timer;
+    timer.start();
+    m_ok = m_query.exec();
+    m_execNanos = timer.nsecsElapsed();
+    m_columns = m_query.isSelect() ? m_query.record().count() : 0;
+    if (!m_query.isSelect() && m_ok)
+        m_rows = qMax(0, m_query.numRowsAffected());
+    return m_ok;
+}
+
+bool ProfiledQuery::exec(const QString &sql)
+{
+    if (m_pending)
+        finish();
+    m_sql = sql;
+    m_prepareNanos = 0;
+    startSample();
+    PB_TRACE_SCOPE_DETAIL("sql.exec", m_label);
+    QElapsedTimer timer;
+    timer.start();
+    m_ok = m_query.exec(sql);
+    m_execNanos = timer.nsecsElapsed();
+    m_columns = m_query.isSelect() ? m_query.record().count() : 0;
+    if (!m_query.isSelect() && m_ok)
+        m_rows = qMax(0, m_query.numRowsAffected());
+    return m_ok;
+}
+
+void ProfiledQuery::countRow()
+{
+    m_rows++;
+    for (int i = 0; i < m_columns; ++i)
+        m_bytes += variantBytes(m_query.value(i));
+}
+
+bool ProfiledQuery::next()
+{
+#ifdef PROBALL_TRACING
+    // The fetch loop shows up as one span, from the first row to the last
+    if (m_fetchBeginNs == 0)
+        m_fetchBeginNs = Trace::nowNs();
+#endif
+    QElapsedTimer timer;
+    timer.start();
+    bool ok = m_query.next();
+    m_fetchNanos += timer.nsecsElapsed();
+#ifdef PROBALL_TRACING
+    m_fetchEndNs = Trace::nowNs();
+#endif
+    if (ok)
+        countRow();
+    return ok;
+}
+
+bool ProfiledQuery::first()
+{
+    // Re-reading rows already fetched is not counted again
+    QElapsedTimer timer;
+    timer.start();
+    bool ok = m_query.first();
+    m_fetchNanos += timer.nsecsElapsed();
+    return ok;
+}
+
+bool ProfiledQuery::previous()
+{
+    return m_query.previous();
+}
+
+QVariant ProfiledQuery::value(int index) const
+{
+    return m_query.value(index);
+}
+
+QVariant ProfiledQuery::value(const QString &name) const
+{
+    return m_query.value(name);
+}
+
+QSqlError ProfiledQuery::lastError() const
+{
+    return m_query.lastError();
+}
+
+int ProfiledQuery::numRowsAffected() const
+{
+    return m_query.numRowsAffected();
+}
+
+void ProfiledQuery::setForwardOnly(bool forward)
+{
+    m_query.setForwardOnly(forward);
+}
+
+void ProfiledQuery::finish()
+{
+    if (!m_pending)
+        return;
+    m_pending = false;
+
+#ifdef PROBALL_TRACING
+    if (m_fetchBeginNs != 0)
+        PB_TRACE_COMPLETE("sql.fetch", m_label, m_fetchBeginNs, m_fetchEndNs - m_fetchBeginNs);
+    m_fetchBeginNs = 0;
+    m_fetchEndNs = 0;
+#endif
+
+    QueryProfiler::instance().record(m_label, m_sql,
+                                     m_prepareNanos / 1000, m_execNanos / 1000, m_fetchNanos / 1000,
+                                     m_rows, m_bytes, m_ok);
+    m_prepareNanos = 0;
+    m_execNanos = 0;
+    m_fetchNanos = 0;
+    m_rows = 0;
+    m_bytes = 0;
+}
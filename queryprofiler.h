@@ -0,0 +1,129 @@
+#ifndef QUERYPROFILER_H
+#define QUERYPROFILER_H
+
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVariant>
+#include <array>
+
+// Log-scale latency histogram (4 buckets per power of two, in microseconds)
+class LatencyHistogram
+{
+public:
+    static constexpr int BucketCount = 128;
+
+    void add(qint64 micros);
+    qint64 percentile(double p) const; // p in [0, 1], result in microseconds
+    qint64 count() const { return m_count; }
+
+private:
+    static int bucketFor(qint64 micros);
+    static qint64 bucketMidpoint(int bucket);
+
+    std::array<qint64, BucketCount> m_buckets{};
+    qint64 m_count = 0;
+    qint64 m_min = 0;
+    qint64 m_max = 0;
+};
+
+// Aggregated timings for one statement label
+struct QueryStatementStats
+{
+    QString label;
+    QString sql;
+    qint64 executions = 0;
+    qint64 failures = 0;
+    qint64 prepareMicros = 0;
+    qint64 execMicros = 0;
+    qint64 fetchMicros = 0;
+    qint64 rows = 0;
+    qint64 bytes = 0;
+    LatencyHistogram latency; // prepare + exec + fetch
+};
+
+// Process-wide registry of query timings, with a slow-query log file
+class QueryProfiler
+{
+public:
+    static QueryProfiler &instance();
+
+    void record(const QString &label, const QString &sql,
+                qint64 prepareMicros, qint64 execMicros, qint64 fetchMicros,
+                qint64 rows, qint64 bytes, bool ok);
+
+    QList<QueryStatementStats> snapshot() const;
+    void reset();
+
+    int slowQueryThresholdMs() const;
+    void setSlowQueryThresholdMs(int ms);
+    QString slowQueryLogPath() const;
+
+private:
+    QueryProfiler();
+    void appendSlowQuery(const QString &label, const QString &sql,
+                         qint64 prepareMicros, qint64 execMicros, qint64 fetchMicros,
+                         qint64 rows, qint64 bytes);
+
+    mutable QMutex m_mutex;
+    QHash<QString, QueryStatementStats> m_stats;
+    int m_slowThresholdMs;
+    QString m_slowLogPath;
+};
+
+// Drop-in wrapper around QSqlQuery that times prepare, exec and fetch.
+// One sample is recorded per exec(), when the next exec() starts or the
+// wrapper is destroyed.
+class ProfiledQuery
+{
+public:
+    ProfiledQuery(const QString &label, const QSqlDatabase &db);
+    ~ProfiledQuery();
+
+    bool prepare(const QString &sql);
+    void bindValue(int pos, const QVariant &value);
+    void bindValue(const QString &placeholder, const QVariant &value);
+    void addBindValue(const QVariant &value);
+    bool exec();
+    bool exec(const QString &sql);
+    bool next();
+    bool first();
+    bool previous();
+    QVariant value(int index) const;
+    QVariant value(const QString &name) const;
+    QSqlError lastError() const;
+    int numRowsAffected() const;
+    void setForwardOnly(bool forward);
+
+    // Records the pending sample now instead of waiting for the destructor
+    void finish();
+
+    QSqlQuery &query() { return m_query; }
+
+private:
+    void startSample();
+    void countRow();
+
+    QString m_label;
+    QString m_sql;
+    QSqlQuery m_query;
+    qint64 m_prepareNanos = 0;
+    qint64 m_execNanos = 0;
+    qint64 m_fetchNanos = 0;
+    int m_columns = 0;
+    qint64 m_rows = 0;
+    qint64 m_bytes = 0;
+    bool m_ok = false;
+    bool m_pending = false;
+#ifdef PROBALL_TRACING
+    qint64 m_fetchBeginNs = 0;
+    qint64 m_fetchEndNs = 0;
+#endif
+};
+
+#endif // QUERYPROFILER_H
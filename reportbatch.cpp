@@ -0,0 +1,158 @@
+#include "reportbatch.h"
+#include "reportwriter.h"
+#include "reportcache.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QSet>
+#include <QTextStream>
+#include <QtConcurrent>
+#include <algorithm>
+#include <atomic>
+
+namespace {
+
+// Keeps file names portable: letters and digits only, the rest becomes '_'
+QString safeFileName(const QString &key)
+{
+    QString name;
+    for (const QChar &c : key.normalized(QString::NormalizationForm_KD)) {
+        if (c.isLetterOrNumber() && c.unicode() < 128)
+            name += c.toLower();
+        else if (c.category() != QChar::Mark_NonSpacing && !name.endsWith('_'))
+            name += '_';
+    }
+    while (name.startsWith('_'))
+        name.remove(0, 1);
+    while (name.endsWith('_'))
+        name.chop(1);
+    return name.isEmpty() ? QString("report") : name;
+}
+
+} // namespace
+
+ReportBatch::ReportBatch(const QVector<Match> &matches, const QList<AttendanceCube::Dimension> &partitionBy,
+                         const QStringList &headers, const QString &outputDir)
+    : m_matches(matches), m_partitionBy(partitionBy), m_headers(headers), m_outputDir(outputDir)
+{
+    partition();
+}
+
+void ReportBatch::partition()
+{
+    // One pass over the snapshot, grouping store rows by the joined key
+    QHash<QString, int> partByKey;
+    for (int row = 0; row < m_matches.size(); ++row) {
+        const QString key = AttendanceCube::keyFor(m_matches[row], m_partitionBy);
+
+        auto it = partByKey.constFind(key);
+        if (it == partByKey.cend()) {
+            it = partByKey.insert(key, m_parts.size());
+            Part part;
+            part.key = key;
+            m_parts.append(part);
+        }
+        m_parts[it.value()].rows.append(row);
+    }
+
+    std::sort(m_parts.begin(), m_parts.end(), [](const Part &a, const Part &b) {
+        return a.key < b.key;
+    });
+
+    // Chronological rows inside a report; unique file names across the batch
+    QSet<QString> usedNames;
+    for (Part &part : m_parts) {
+        std::sort(part.rows.begin(), part.rows.end(), [this](int a, int b) {
+            const Match &left = m_matches[a];
+            const Match &right = m_matches[b];
+            if (left.date != right.date)
+                return left.date < right.date;
+            return left.id < right.id;
+        });
+
+        QString base = safeFileName(part.key);
+        QString name = base;
+        for (int suffix = 2; usedNames.contains(name); ++suffix)
+            name = QString("%1_%2").arg(base).arg(suffix);
+        usedNames.insert(name);
+        part.fileName = name + ".pdf";
+    }
+}
+
+void ReportBatch::run(QPromise<ReportJobResult> &promise)
+{
+    ReportJobResult result;
+    if (!QDir().mkpath(m_outputDir)) {
+        result.message = "Cannot create the output directory.";
+        promise.addResult(result);
+        return;
+    }
+
+    promise.setProgressRange(0, qMax(1, int(m_matches.size())));
+    std::atomic<int> rowsWritten(0);
+    const QDir dir(m_outputDir);
+
+    // Every partition is independent: lay out and write them all at once
+    QtConcurrent::blockingMap(m_parts, [&](Part &part) {
+        if (promise.isCanceled())
+            return;
+
+        MatchRowSource rows(m_matches, part.rows, m_headers);
+        TableReportWriter writer("Matches Report - " + part.key);
+        writer.setPageCache(&ReportCache::instance());
+        int reported = 0;
+        writer.setProgressCallback([&](int written) {
+            promise.setProgressValue(rowsWritten += written - reported);
+            reported = written;
+            return !promise.isCanceled();
+        });
+        part.ok = writer.writePdf(dir.filePath(part.fileName), rows);
+        part.pageCount = writer.pageCount();
+        part.error = writer.errorString();
+        promise.setProgressValue(rowsWritten += int(part.rows.size()) - reported);
+    });
+
+    if (promise.isCanceled())
+        return;
+
+    int failed = 0;
+    for (const Part &part : std::as_const(m_parts)) {
+        if (!part.ok) {
+            qDebug() << "Batch report failed for" << part.key << part.error;
+            failed++;
+        }
+    }
+
+    QString indexError;
+    if (!writeIndex(&indexError)) {
+        result.message = indexError;
+    } else if (failed > 0) {
+        result.message = QString("%1 of %2 reports failed; see index.csv").arg(failed).arg(m_parts.size());
+    } else {
+        result.ok = true;
+        result.message = m_outputDir;
+    }
+    promise.addResult(result);
+}
+
+bool ReportBatch::writeIndex(QString *error) const
+{
+    QFile file(QDir(m_outputDir).filePath("index.csv"));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        if (error)
+            *error = "Cannot write index.csv: " + file.errorString();
+        return false;
+    }
+
+    QTextStream out(&file);
+    out << "partition,file,matches,pages,status\n";
+    for (const Part &part : m_parts) {
+        out << CsvReportWriter::field(part.key) << ','
+            << CsvReportWriter::field(part.ok ? part.fileName : QString()) << ','
+            << part.rows.size() << ','
+            << part.pageCount << ','
+            << CsvReportWriter::field(part.ok ? QString("ok") : part.error) << '\n';
+    }
+    return true;
+}
@@ -0,0 +1,48 @@
+#ifndef REPORTBATCH_H
+#define REPORTBATCH_H
+
+#include <QList>
+#include <QPromise>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "attendancecube.h"
+#include "matches.h"
+#include "reportjobs.h"
+
+// Produces one matches PDF per partition (venue, month, venue x month...)
+// of a store snapshot. Partitions render concurrently on the global thread
+// pool and an index.csv listing every file is written next to them.
+class ReportBatch
+{
+public:
+    struct Part
+    {
+        QString key;        // partition values joined with " / "
+        QString fileName;   // relative to the output directory
+        QVector<int> rows;  // store rows, ordered by date then ID
+        int pageCount = 0;
+        bool ok = false;
+        QString error;
+    };
+
+    ReportBatch(const QVector<Match> &matches, const QList<AttendanceCube::Dimension> &partitionBy,
+                const QStringList &headers, const QString &outputDir);
+
+    const QVector<Part> &parts() const { return m_parts; }
+
+    // Meant to run as a ReportJobManager job; progress counts rows written
+    void run(QPromise<ReportJobResult> &promise);
+
+private:
+    void partition();
+    bool writeIndex(QString *error) const;
+
+    QVector<Match> m_matches;
+    QList<AttendanceCube::Dimension> m_partitionBy;
+    QStringList m_headers;
+    QString m_outputDir;
+    QVector<Part> m_parts;
+};
+
+#endif // REPORTBATCH_H
@@ -0,0 +1,225 @@
+#include "reportcache.h"
+#include "reportwriter.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+
+// ReportKey implementation
+ReportKey::ReportKey(const QString &kind)
+    : m_hash(QCryptographicHash::Sha256)
+{
+    add(kind);
+}
+
+ReportKey &ReportKey::add(const QByteArray &value)
+{
+    const qint64 size = value.size();
+    m_hash.addData(QByteArrayView(reinterpret_cast<const char *>(&size), sizeof(size)));
+    m_hash.addData(value);
+    return *this;
+}
+
+ReportKey &ReportKey::add(const QString &value)
+{
+    return add(value.toUtf8());
+}
+
+ReportKey &ReportKey::add(qint64 value)
+{
+    return add(QByteArray::number(value));
+}
+
+ReportKey &ReportKey::add(const QStringList &values)
+{
+    add(qint64(values.size()));
+    for (const QString &value : values)
+        add(value);
+    return *this;
+}
+
+ReportKey &ReportKey::addRows(ReportRowSource &source)
+{
+    add(source.headers());
+    QStringList row;
+    qint64 rows = 0;
+    while (source.next(row)) {
+        add(row);
+        rows++;
+    }
+    return add(rows);
+}
+
+QByteArray ReportKey::result() const
+{
+    return m_hash.result().toHex();
+}
+
+// ReportCache implementation
+ReportCache &ReportCache::instance()
+{
+    static ReportCache cache;
+    return cache;
+}
+
+ReportCache::ReportCache()
+    : m_maxBytes(256LL * 1024 * 1024), m_totalBytes(-1)
+{
+    // Size limit can be tuned per deployment without rebuilding
+    bool ok = false;
+    int envMegabytes = qEnvironmentVariableIntValue("PROBALL_REPORT_CACHE_MB", &ok);
+    if (ok && envMegabytes >= 0)
+        m_maxBytes = qint64(envMegabytes) * 1024 * 1024;
+
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (dir.isEmpty())
+        dir = QDir(QDir::tempPath()).filePath("proball-cache");
+    m_directory = QDir(dir).filePath("reports");
+    QDir().mkpath(QDir(m_directory).filePath("pages"));
+}
+
+qint64 ReportCache::maxBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_maxBytes;
+}
+
+void ReportCache::setMaxBytes(qint64 bytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_maxBytes = bytes;
+    evictLocked();
+}
+
+void ReportCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    QDir(m_directory).removeRecursively();
+    QDir().mkpath(QDir(m_directory).filePath("pages"));
+    m_totalBytes = 0;
+    m_lastUsed.clear();
+}
+
+QString ReportCache::pathFor(const QByteArray &key, const QString &suffix) const
+{
+    if (suffix == "page")
+        return QDir(m_directory).filePath("pages/" + QString::fromLatin1(key) + ".pic");
+    return QDir(m_directory).filePath(QString::fromLatin1(key) + "." + suffix);
+}
+
+QString ReportCache::lookup(const QByteArray &key, const QString &suffix)
+{
+    const QString path = pathFor(key, suffix);
+    if (!QFile::exists(path))
+        return QString();
+
+    used(path);
+    return path;
+}
+
+bool ReportCache::copyTo(const QByteArray &key, const QString &suffix, const QString &destination)
+{
+    const QString cached = lookup(key, suffix);
+    if (cached.isEmpty())
+        return false;
+
+    QFile::remove(destination);
+    return QFile::copy(cached, destination);
+}
+
+bool ReportCache::store(const QByteArray &key, const QString &suffix, const QString &sourceFile)
+{
+    const QString path = pathFor(key, suffix);
+    const QString temporary = path + ".part";
+
+    // Copy then rename, so a reader never sees a half-written entry
+    QFile::remove(temporary);
+    if (!QFile::copy(sourceFile, temporary))
+        return false;
+    QFile::remove(path);
+    if (!QFile::rename(temporary, path)) {
+        QFile::remove(temporary);
+        return false;
+    }
+
+    added(QFileInfo(path).size());
+    return true;
+}
+
+bool ReportCache::loadPage(const QByteArray &key, QPicture *picture)
+{
+    const QString path = lookup(key, "page");
+    return !path.isEmpty() && picture->load(path);
+}
+
+void ReportCache::storePage(const QByteArray &key, const QPicture &picture)
+{
+    const QString path = pathFor(key, "page");
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+    file.write(picture.data(), picture.size());
+    if (file.commit())
+        added(picture.size());
+}
+
+void ReportCache::used(const QString &path)
+{
+    QMutexLocker locker(&m_mutex);
+    m_lastUsed.insert(path, QDateTime::currentDateTimeUtc());
+}
+
+void ReportCache::added(qint64 bytes)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_totalBytes >= 0)
+        m_totalBytes += bytes;
+    evictLocked();
+}
+
+void ReportCache::evictLocked()
+{
+    // Scan lazily the first time; afterwards the running total is enough
+    // to know when a scan-and-evict pass is needed
+    if (m_totalBytes >= 0 && m_totalBytes <= m_maxBytes)
+        return;
+
+    QList<QFileInfo> entries;
+    qint64 total = 0;
+    QDirIterator it(m_directory, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        QFileInfo info(it.next());
+        if (info.fileName().endsWith(".part"))
+            continue;
+        entries.append(info);
+        total += info.size();
+    }
+
+    if (total > m_maxBytes) {
+        // Least recently written or hit first
+        auto lastUsed = [this](const QFileInfo &info) {
+            const QDateTime written = info.lastModified().toUTC();
+            return qMax(written, m_lastUsed.value(info.filePath()));
+        };
+        std::sort(entries.begin(), entries.end(), [&](const QFileInfo &a, const QFileInfo &b) {
+            return lastUsed(a) < lastUsed(b);
+        });
+        int evicted = 0;
+        for (const QFileInfo &info : std::as_const(entries)) {
+            if (total <= m_maxBytes)
+                break;
+            if (QFile::remove(info.filePath())) {
+                m_lastUsed.remove(info.filePath());
+                total -= info.size();
+                evicted++;
+            }
+        }
+        qDebug() << "Report cache evicted" << evicted << "entries," << total << "bytes kept";
+    }
+    m_totalBytes = total;
+}
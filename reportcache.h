@@ -0,0 +1,74 @@
+#ifndef REPORTCACHE_H
+#define REPORTCACHE_H
+
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QPicture>
+#include <QString>
+#include <QStringList>
+
+class ReportRowSource;
+
+// Builds the SHA-256 key of a report from everything that affects its output.
+// Each value is length-prefixed so ("ab", "c") and ("a", "bc") differ.
+class ReportKey
+{
+public:
+    explicit ReportKey(const QString &kind);
+
+    ReportKey &add(const QString &value);
+    ReportKey &add(qint64 value);
+    ReportKey &add(const QByteArray &value);
+    ReportKey &add(const QStringList &values);
+    ReportKey &addRows(ReportRowSource &source); // consumes the source
+
+    QByteArray result() const;
+
+private:
+    QCryptographicHash m_hash;
+};
+
+// On-disk, content-addressed cache of generated reports, shared by every
+// export. Whole files are stored as <key>.<suffix>; table pages are stored
+// as recorded QPictures so a report with a few changed rows only re-lays out
+// the pages those rows land on. Least recently used entries are evicted
+// once the cache grows past its size limit (PROBALL_REPORT_CACHE_MB, 256 MB).
+class ReportCache
+{
+public:
+    static ReportCache &instance();
+
+    QString directory() const { return m_directory; }
+    qint64 maxBytes() const;
+    void setMaxBytes(qint64 bytes);
+    void clear();
+
+    // Whole artifacts
+    QString lookup(const QByteArray &key, const QString &suffix);
+    bool copyTo(const QByteArray &key, const QString &suffix, const QString &destination);
+    bool store(const QByteArray &key, const QString &suffix, const QString &sourceFile);
+
+    // Recorded table pages
+    bool loadPage(const QByteArray &key, QPicture *picture);
+    void storePage(const QByteArray &key, const QPicture &picture);
+
+private:
+    ReportCache();
+    QString pathFor(const QByteArray &key, const QString &suffix) const;
+    void used(const QString &path);
+    void added(qint64 bytes);
+    void evictLocked();
+
+    mutable QMutex m_mutex;
+    QString m_directory;
+    qint64 m_maxBytes;
+    qint64 m_totalBytes; // -1 until the directory has been scanned
+    // Last hit per entry path this session; files are never opened for write
+    // on a hit, so entries only read since startup fall back to their mtime
+    QHash<QString, QDateTime> m_lastUsed;
+};
+
+#endif // REPORTCACHE_H
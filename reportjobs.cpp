@@ -0,0 +1,73 @@
+#include "reportjobs.h"
+#include <QtConcurrent>
+
+ReportJobManager::ReportJobManager(QObject *parent)
+    : QObject(parent)
+{
+    // Leave cores free for the GUI and the database driver
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() / 2));
+}
+
+ReportJobManager::~ReportJobManager()
+{
+    cancelAll();
+    m_pool.waitForDone();
+}
+
+void ReportJobManager::submit(const QString &title, Work work)
+{
+    QFutureWatcher<ReportJobResult> *watcher = new QFutureWatcher<ReportJobResult>(this);
+    m_jobs.append({title, watcher});
+
+    connect(watcher, &QFutureWatcher<ReportJobResult>::progressValueChanged, this, &ReportJobManager::updateProgress);
+    connect(watcher, &QFutureWatcher<ReportJobResult>::progressRangeChanged, this, &ReportJobManager::updateProgress);
+    connect(watcher, &QFutureWatcher<ReportJobResult>::finished, this, [this, watcher, title]() {
+        for (int i = 0; i < m_jobs.size(); ++i) {
+            if (m_jobs[i].watcher == watcher) {
+                m_jobs.removeAt(i);
+                break;
+            }
+        }
+
+        bool cancelled = watcher->isCanceled();
+        ReportJobResult result;
+        if (!cancelled && watcher->future().resultCount() > 0)
+            result = watcher->result();
+        else if (!cancelled)
+            result.message = "The job produced no result.";
+
+        watcher->deleteLater();
+        updateProgress();
+        emit jobFinished(title, result.ok && !cancelled, cancelled, result.message);
+    });
+
+    watcher->setFuture(QtConcurrent::run(&m_pool, [work](QPromise<ReportJobResult> &promise) {
+        work(promise);
+    }));
+    emit jobStarted(title);
+    updateProgress();
+}
+
+void ReportJobManager::cancelAll()
+{
+    for (const Job &job : std::as_const(m_jobs))
+        job.watcher->cancel();
+}
+
+void ReportJobManager::updateProgress()
+{
+    if (m_jobs.isEmpty()) {
+        emit progressChanged(100);
+        return;
+    }
+
+    // Average of the per-job percentages
+    int total = 0;
+    for (const Job &job : std::as_const(m_jobs)) {
+        int minimum = job.watcher->progressMinimum();
+        int maximum = job.watcher->progressMaximum();
+        if (maximum > minimum)
+            total += (job.watcher->progressValue() - minimum) * 100 / (maximum - minimum);
+    }
+    emit progressChanged(total / m_jobs.size());
+}
@@ -0,0 +1,55 @@
+#ifndef REPORTJOBS_H
+#define REPORTJOBS_H
+
+#include <QObject>
+#include <QFutureWatcher>
+#include <QList>
+#include <QPromise>
+#include <QString>
+#include <QThreadPool>
+#include <functional>
+
+// Outcome of a report job, delivered back on the GUI thread
+struct ReportJobResult
+{
+    bool ok = false;
+    QString message; // output path on success, error text otherwise
+};
+
+// Runs report jobs on a dedicated thread pool. Jobs report progress and
+// check for cancellation through their QPromise; they must only read data
+// captured up front (snapshots), never GUI objects.
+class ReportJobManager : public QObject
+{
+    Q_OBJECT
+public:
+    using Work = std::function<void(QPromise<ReportJobResult> &promise)>;
+
+    explicit ReportJobManager(QObject *parent = nullptr);
+    ~ReportJobManager();
+
+    void submit(const QString &title, Work work);
+    int activeJobs() const { return m_jobs.size(); }
+
+public slots:
+    void cancelAll();
+
+signals:
+    void jobStarted(const QString &title);
+    void progressChanged(int percent); // combined progress of all active jobs
+    void jobFinished(const QString &title, bool ok, bool cancelled, const QString &message);
+
+private:
+    struct Job
+    {
+        QString title;
+        QFutureWatcher<ReportJobResult> *watcher;
+    };
+
+    void updateProgress();
+
+    QThreadPool m_pool;
+    QList<Job> m_jobs;
+};
+
+#endif // REPORTJOBS_H
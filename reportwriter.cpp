@@ -0,0 +1,319 @@
+#include "reportwriter.h"
+#include "reportcache.h"
+#include "trace.h"
+#include <QDateTime>
+#include <QFile>
+#include <QFontMetricsF>
+#include <QPainter>
+#include <QPdfWriter>
+#include <QPicture>
+#include <QTextStream>
+
+// MatchRowSource implementation
+MatchRowSource::MatchRowSource(const QVector<Match> &matches, const QVector<int> &order, const QStringList &headers)
+    : m_matches(matches), m_order(order), m_headers(headers), m_position(0)
+{
+}
+
+QStringList MatchRowSource::defaultHeaders()
+{
+    return {"ID", "Date", "Lieu", "Status", "Score", "Type", "Spectateurs"};
+}
+
+QString MatchRowSource::formatCell(const QVariant &value)
+{
+    // Format dates nicely, everything else as plain text
+    if (value.typeId() == QMetaType::QDateTime)
+        return value.toDateTime().toString("yyyy-MM-dd HH:mm");
+    return value.toString();
+}
+
+bool MatchRowSource::next(QStringList &row)
+{
+    if (m_position >= m_order.size())
+        return false;
+
+    // Same column order and formatting as the MATCHES table model
+    const Match &match = m_matches[m_order[m_position++]];
+    row.clear();
+    row << QString::number(match.id)
+        << formatCell(match.date)
+        << match.lieu
+        << match.status
+        << match.score
+        << match.type
+        << match.spectateursText;
+    return true;
+}
+
+// TableReportWriter implementation
+TableReportWriter::TableReportWriter(const QString &title)
+    : m_title(title),
+      m_titleFont("Arial", 16, QFont::Bold),
+      m_headerFont("Arial", 9, QFont::Bold),
+      m_cellFont("Arial", 9),
+      m_footerFont("Arial", 8),
+      m_sampleRows(200),
+      m_pageCount(0),
+      m_rowCount(0),
+      m_cachedPages(0),
+      m_pageCache(nullptr)
+{
+}
+
+QVector<qreal> TableReportWriter::columnWidths(const QStringList &headers, const QVector<QStringList> &sample, qreal available,
+                                               const QFont &headerFont, const QFont &cellFont, QPaintDevice *device) const
+{
+    QFontMetricsF headerMetrics(headerFont, device);
+    QFontMetricsF cellMetrics(cellFont, device);
+    const qreal padding = cellMetrics.height() * 0.35;
+
+    // Natural width: widest of the header and the sampled cells
+    QVector<qreal> widths(headers.size());
+    qreal total = 0;
+    for (int col = 0; col < headers.size(); ++col) {
+        qreal width = headerMetrics.horizontalAdvance(headers[col]);
+        for (const QStringList &row : sample) {
+            if (col < row.size())
+                width = qMax(width, cellMetrics.horizontalAdvance(row[col]));
+        }
+        widths[col] = width + 2 * padding;
+        total += widths[col];
+    }
+
+    // Stretch or shrink proportionally to the page width
+    if (total > 0) {
+        qreal factor = available / total;
+        for (qreal &width : widths)
+            width *= factor;
+    }
+    return widths;
+}
+
+// Fonts sized in device pixels: the same on the device and inside a QPicture
+static QFont deviceFont(const QFont &font, const QPaintDevice *device)
+{
+    QFont sized = font;
+    if (font.pointSizeF() > 0)
+        sized.setPixelSize(qMax(1, qRound(font.pointSizeF() * device->logicalDpiY() / 72.0)));
+    return sized;
+}
+
+bool TableReportWriter::write(QPagedPaintDevice *device, ReportRowSource &source)
+{
+    m_pageCount = 0;
+    m_rowCount = 0;
+    m_cachedPages = 0;
+    m_error.clear();
+
+    QPainter painter;
+    if (!painter.begin(device)) {
+        m_error = "Cannot open the output file for writing.";
+        return false;
+    }
+
+    const QFont titleFont = deviceFont(m_titleFont, device);
+    const QFont headerFont = deviceFont(m_headerFont, device);
+    const QFont cellFont = deviceFont(m_cellFont, device);
+    const QFont footerFont = deviceFont(m_footerFont, device);
+
+    const QRectF page(0, 0, device->width(), device->height());
+    QFontMetricsF cellMetrics(cellFont, device);
+    QFontMetricsF headerMetrics(headerFont, device);
+    const qreal padding = cellMetrics.height() * 0.35;
+    const qreal rowHeight = cellMetrics.height() + 2 * padding;
+    const qreal headerHeight = headerMetrics.height() + 2 * padding;
+    const qreal titleHeight = QFontMetricsF(titleFont, device).height() * 1.8;
+    const qreal footerHeight = QFontMetricsF(footerFont, device).height() * 1.5;
+    const QString generatedOn = "Generated on: " + QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss");
+
+    // Buffer only a sample of rows to size the columns
+    const QStringList headers = source.headers();
+    QVector<QStringList> sample;
+    QStringList row;
+    while (sample.size() < m_sampleRows && source.next(row))
+        sample.append(row);
+    const QVector<qreal> widths = columnWidths(headers, sample, page.width(), headerFont, cellFont, device);
+
+    int sampleIndex = 0;
+    auto nextRow = [&](QStringList &out) {
+        if (sampleIndex < sample.size()) {
+            out = sample[sampleIndex++];
+            return true;
+        }
+        if (!sample.isEmpty()) {
+            sample.clear(); // release the sample once it has been printed
+            sampleIndex = 0;
+        }
+        return source.next(out);
+    };
+
+    // Everything that shapes a page besides its rows; cached pages are keyed on it
+    QByteArray layoutKey;
+    if (m_pageCache) {
+        ReportKey key("table-page/v1");
+        key.add(m_title).add(headers).add(qint64(page.width())).add(qint64(page.height()))
+           .add(titleFont.toString()).add(headerFont.toString()).add(cellFont.toString());
+        for (qreal width : widths)
+            key.add(qint64(qRound(width * 100)));
+        layoutKey = key.result();
+    }
+
+    auto drawCells = [&](QPainter &target, const QStringList &cells, qreal top, qreal height, const QFontMetricsF &metrics) {
+        qreal x = 0;
+        for (int col = 0; col < widths.size(); ++col) {
+            QRectF cell(x, top, widths[col], height);
+            target.drawRect(cell);
+            if (col < cells.size()) {
+                QString text = metrics.elidedText(cells[col], Qt::ElideRight, widths[col] - 2 * padding);
+                target.drawText(cell.adjusted(padding, 0, -padding, 0), Qt::AlignLeft | Qt::AlignVCenter, text);
+            }
+            x += widths[col];
+        }
+    };
+
+    // Title (first page), header row and the page's rows; the footer is drawn
+    // separately because its timestamp changes on every run
+    auto paintPage = [&](QPainter &target, int pageNumber, const QVector<QStringList> &rows) {
+        qreal y = 0;
+        target.setPen(QPen(Qt::black, 0));
+        target.setBrush(Qt::NoBrush);
+        if (pageNumber == 1) {
+            target.setFont(titleFont);
+            target.drawText(QRectF(0, 0, page.width(), titleHeight), Qt::AlignLeft | Qt::AlignVCenter, m_title);
+            y = titleHeight;
+        }
+
+        // Repeat the header row on every page
+        target.setFont(headerFont);
+        target.fillRect(QRectF(0, y, page.width(), headerHeight), QColor(230, 230, 230));
+        drawCells(target, headers, y, headerHeight, headerMetrics);
+        y += headerHeight;
+
+        target.setFont(cellFont);
+        for (const QStringList &cells : rows) {
+            drawCells(target, cells, y, rowHeight, cellMetrics);
+            y += rowHeight;
+        }
+    };
+
+    const qreal bodyHeight = page.height() - footerHeight - headerHeight;
+    QVector<QStringList> pageRows;
+    int pageNumber = 0;
+    bool more = true;
+
+    while (more || pageNumber == 0) {
+        PB_TRACE_SCOPE("report.page");
+        // Gather exactly one page of rows
+        const int capacity = qMax(1, int((bodyHeight - (pageNumber == 0 ? titleHeight : 0)) / rowHeight));
+        pageRows.clear();
+        while (pageRows.size() < capacity && (more = nextRow(row)))
+            pageRows.append(row);
+        if (pageRows.isEmpty() && pageNumber > 0)
+            break;
+
+        if (pageNumber > 0 && !device->newPage()) {
+            m_error = "Cannot start a new page.";
+            painter.end();
+            return false;
+        }
+        pageNumber++;
+
+        if (m_pageCache) {
+            ReportKey key("table-page/v1");
+            key.add(layoutKey).add(qint64(pageNumber));
+            for (const QStringList &cells : std::as_const(pageRows))
+                key.add(cells);
+            const QByteArray pageKey = key.result();
+
+            // Replay an identical page; otherwise record it for next time
+            QPicture picture;
+            if (m_pageCache->loadPage(pageKey, &picture)) {
+                m_cachedPages++;
+            } else {
+                QPainter recorder(&picture);
+                paintPage(recorder, pageNumber, pageRows);
+                recorder.end();
+                m_pageCache->storePage(pageKey, picture);
+            }
+            painter.drawPicture(0, 0, picture);
+        } else {
+            paintPage(painter, pageNumber, pageRows);
+        }
+
+        painter.setPen(QPen(Qt::black, 0));
+        painter.setFont(footerFont);
+        QRectF footer(0, page.height() - footerHeight, page.width(), footerHeight);
+        painter.drawText(footer, Qt::AlignLeft | Qt::AlignVCenter, generatedOn);
+        painter.drawText(footer, Qt::AlignRight | Qt::AlignVCenter, QString("Page %1").arg(pageNumber));
+
+        m_rowCount += pageRows.size();
+        if (m_progress && !m_progress(m_rowCount)) {
+            m_error = "Cancelled.";
+            painter.end();
+            return false;
+        }
+    }
+
+    m_pageCount = pageNumber;
+    painter.end();
+    return true;
+}
+
+bool TableReportWriter::writePdf(const QString &fileName, ReportRowSource &source)
+{
+    PB_TRACE_SCOPE_DETAIL("export.pdf", m_title);
+
+    bool ok;
+    {
+        QPdfWriter pdf(fileName);
+        pdf.setResolution(1200);
+        pdf.setPageOrientation(QPageLayout::Landscape);
+        ok = write(&pdf, source);
+    }
+
+    if (!ok)
+        QFile::remove(fileName); // do not leave a truncated file behind
+    return ok;
+}
+
+// CsvReportWriter implementation
+QString CsvReportWriter::field(const QString &value)
+{
+    if (!value.contains(',') && !value.contains('"') && !value.contains('\n') && !value.contains('\r'))
+        return value;
+    QString quoted = value;
+    quoted.replace("\"", "\"\"");
+    return "\"" + quoted + "\"";
+}
+
+bool CsvReportWriter::write(QIODevice *device, ReportRowSource &source)
+{
+    PB_TRACE_SCOPE("export.csv");
+    m_rowCount = 0;
+    m_error.clear();
+
+    QTextStream out(device);
+    auto writeLine = [&out](const QStringList &cells) {
+        for (int col = 0; col < cells.size(); ++col) {
+            if (col > 0)
+                out << ',';
+            out << field(cells[col]);
+        }
+        out << "\r\n";
+    };
+
+    writeLine(source.headers());
+    QStringList row;
+    while (source.next(row)) {
+        writeLine(row);
+        m_rowCount++;
+    }
+
+    out.flush();
+    if (out.status() != QTextStream::Ok) {
+        m_error = "Write error: " + device->errorString();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,101 @@
+#ifndef REPORTWRITER_H
+#define REPORTWRITER_H
+
+#include <QIODevice>
+#include <QPagedPaintDevice>
+#include <QFont>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+#include <functional>
+#include "matches.h"
+
+class ReportCache;
+
+// Supplies report rows one at a time so a report never holds the whole table
+class ReportRowSource
+{
+public:
+    virtual ~ReportRowSource() = default;
+    virtual QStringList headers() const = 0;
+    virtual bool next(QStringList &row) = 0;
+};
+
+// Reads rows from a MatchStore snapshot in a fixed order (store row indexes).
+// Holds no GUI objects, so it can be consumed on a worker thread.
+class MatchRowSource : public ReportRowSource
+{
+public:
+    MatchRowSource(const QVector<Match> &matches, const QVector<int> &order, const QStringList &headers);
+    static QStringList defaultHeaders(); // same labels as the matches table
+    QStringList headers() const override { return m_headers; }
+    bool next(QStringList &row) override;
+    int size() const { return m_order.size(); }
+
+    static QString formatCell(const QVariant &value);
+
+private:
+    QVector<Match> m_matches;
+    QVector<int> m_order;
+    QStringList m_headers;
+    int m_position;
+};
+
+// Paints a paginated table straight onto a paged device (QPrinter/QPdfWriter).
+// Column widths come from the first rows, the header repeats on every page and
+// rows are painted as they are read, so memory stays flat with row count.
+class TableReportWriter
+{
+public:
+    explicit TableReportWriter(const QString &title);
+
+    void setSampleRows(int rows) { m_sampleRows = rows; }
+    // Called after each page with the rows written so far; return false to cancel
+    void setProgressCallback(std::function<bool(int)> callback) { m_progress = std::move(callback); }
+    // Reuses recorded pages whose layout and rows are unchanged
+    void setPageCache(ReportCache *cache) { m_pageCache = cache; }
+    bool write(QPagedPaintDevice *device, ReportRowSource &source);
+    // Landscape PDF file; only pages are cached, the dated footer is always drawn
+    bool writePdf(const QString &fileName, ReportRowSource &source);
+
+    int pageCount() const { return m_pageCount; }
+    int rowCount() const { return m_rowCount; }
+    int cachedPages() const { return m_cachedPages; }
+    QString errorString() const { return m_error; }
+
+private:
+    QVector<qreal> columnWidths(const QStringList &headers, const QVector<QStringList> &sample, qreal available,
+                                const QFont &headerFont, const QFont &cellFont, QPaintDevice *device) const;
+
+    QString m_title;
+    QFont m_titleFont;
+    QFont m_headerFont;
+    QFont m_cellFont;
+    QFont m_footerFont;
+    int m_sampleRows;
+    int m_pageCount;
+    int m_rowCount;
+    int m_cachedPages;
+    ReportCache *m_pageCache;
+    QString m_error;
+    std::function<bool(int)> m_progress;
+};
+
+// Streams rows as RFC 4180 CSV (UTF-8, comma separated, header line first)
+class CsvReportWriter
+{
+public:
+    bool write(QIODevice *device, ReportRowSource &source);
+
+    int rowCount() const { return m_rowCount; }
+    QString errorString() const { return m_error; }
+
+    static QString field(const QString &value);
+
+private:
+    int m_rowCount = 0;
+    QString m_error;
+};
+
+#endif // REPORTWRITER_H
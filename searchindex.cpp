@@ -0,0 +1,167 @@
+#include "searchindex.h"
+#include <algorithm>
+
+QString TrigramIndex::normalize(const QString &text)
+{
+    // Decompose accented letters and drop the combining marks
+    const QString decomposed = text.normalized(QString::NormalizationForm_D);
+    QString folded;
+    folded.reserve(decomposed.size());
+    for (QChar c : decomposed) {
+        if (c.category() == QChar::Mark_NonSpacing)
+            continue;
+        folded.append(c.isLetterOrNumber() ? c.toCaseFolded() : QChar(' '));
+    }
+    return folded.simplified();
+}
+
+QVector<quint64> TrigramIndex::trigrams(const QString &text)
+{
+    QVector<quint64> result;
+    const QStringList words = normalize(text).split(' ', Qt::SkipEmptyParts);
+    for (const QString &word : words) {
+        // Pad so word starts and short words still produce trigrams
+        const QString padded = "  " + word + " ";
+        for (int i = 0; i + 3 <= padded.size(); ++i) {
+            quint64 key = (quint64(padded[i].unicode()) << 32)
+                        | (quint64(padded[i + 1].unicode()) << 16)
+                        | quint64(padded[i + 2].unicode());
+            result.append(key);
+        }
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+QString TrigramIndex::documentText(const Match &match)
+{
+    return match.lieu + ' ' + match.type + ' ' + match.status;
+}
+
+void TrigramIndex::build(const QVector<Match> &matches)
+{
+    m_valueIndex.clear();
+    m_values.clear();
+    m_freeValues.clear();
+    m_postings.clear();
+    m_matchCount = 0;
+    for (const Match &match : matches)
+        addMatch(match);
+}
+
+void TrigramIndex::addMatch(const Match &match)
+{
+    const QString text = documentText(match);
+    auto found = m_valueIndex.constFind(text);
+    int slot;
+    if (found != m_valueIndex.cend()) {
+        slot = found.value();
+    } else {
+        // First match with this text: index its trigrams once
+        const QVector<quint64> keys = trigrams(text);
+        if (m_freeValues.isEmpty()) {
+            slot = m_values.size();
+            m_values.append(Value());
+        } else {
+            slot = m_freeValues.takeLast();
+        }
+        m_values[slot].trigramCount = keys.size();
+        for (quint64 key : keys)
+            m_postings[key].append(slot);
+        m_valueIndex.insert(text, slot);
+    }
+
+    if (!m_values[slot].ids.contains(match.id)) {
+        m_values[slot].ids.insert(match.id);
+        m_matchCount++;
+    }
+}
+
+void TrigramIndex::removeMatch(const Match &match)
+{
+    const QString text = documentText(match);
+    auto found = m_valueIndex.find(text);
+    if (found == m_valueIndex.end())
+        return;
+    const int slot = found.value();
+    Value &value = m_values[slot];
+    if (!value.ids.remove(match.id))
+        return;
+    m_matchCount--;
+    if (!value.ids.isEmpty())
+        return;
+
+    // Last match with this text: unlink it (posting lists hold distinct texts only)
+    const QVector<quint64> keys = trigrams(text);
+    for (quint64 key : keys) {
+        auto it = m_postings.find(key);
+        if (it == m_postings.end())
+            continue;
+        it->removeOne(slot);
+        if (it->isEmpty())
+            m_postings.erase(it);
+    }
+    m_valueIndex.erase(found);
+    value = Value();
+    m_freeValues.append(slot);
+}
+
+void TrigramIndex::updateMatch(const Match &before, const Match &after)
+{
+    // Only re-index when one of the searchable columns changed
+    if (before.id == after.id && documentText(before) == documentText(after))
+        return;
+    removeMatch(before);
+    addMatch(after);
+}
+
+QVector<TrigramIndex::Hit> TrigramIndex::search(const QString &text, double minScore) const
+{
+    QVector<Hit> hits;
+    const QVector<quint64> keys = trigrams(text);
+    if (keys.isEmpty())
+        return hits;
+
+    QHash<int, int> shared; // value slot -> query trigrams found
+    for (quint64 key : keys) {
+        auto it = m_postings.constFind(key);
+        if (it == m_postings.cend())
+            continue;
+        for (int slot : *it)
+            shared[slot]++;
+    }
+
+    struct Candidate
+    {
+        int slot;
+        double score;
+    };
+    QVector<Candidate> candidates;
+    int hitCount = 0;
+    for (auto it = shared.cbegin(); it != shared.cend(); ++it) {
+        double score = double(it.value()) / keys.size();
+        if (score >= minScore) {
+            candidates.append({it.key(), score});
+            hitCount += m_values[it.key()].ids.size();
+        }
+    }
+
+    // Rank by query coverage, then prefer shorter documents (tighter matches)
+    std::sort(candidates.begin(), candidates.end(), [this](const Candidate &a, const Candidate &b) {
+        if (a.score != b.score)
+            return a.score > b.score;
+        return m_values[a.slot].trigramCount < m_values[b.slot].trigramCount;
+    });
+
+    hits.reserve(hitCount);
+    for (const Candidate &candidate : std::as_const(candidates)) {
+        const int first = hits.size();
+        for (int id : m_values[candidate.slot].ids)
+            hits.append({id, candidate.score});
+        std::sort(hits.begin() + first, hits.end(), [](const Hit &a, const Hit &b) {
+            return a.id < b.id;
+        });
+    }
+    return hits;
+}
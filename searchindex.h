@@ -0,0 +1,52 @@
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QVector>
+#include "matches.h"
+
+// Trigram inverted index over LIEU, TYPEMATCH and STATUS. Text is folded to
+// lower case without accents, so "competitif" finds "compétitif", and
+// scoring by shared trigrams tolerates typos. Those columns repeat a few
+// hundred combinations across the whole table, so trigrams point at the
+// distinct combinations and each combination holds the IDs that carry it.
+class TrigramIndex
+{
+public:
+    struct Hit
+    {
+        int id;
+        double score; // fraction of the query trigrams found, 0..1
+    };
+
+    static QString normalize(const QString &text);
+    static QVector<quint64> trigrams(const QString &text);
+
+    void build(const QVector<Match> &matches);
+    void addMatch(const Match &match);
+    void removeMatch(const Match &match);
+    void updateMatch(const Match &before, const Match &after);
+
+    // Best hits first; hits below minScore are dropped
+    QVector<Hit> search(const QString &text, double minScore = 0.5) const;
+    int size() const { return m_matchCount; }
+
+private:
+    struct Value
+    {
+        int trigramCount = 0; // distinct trigrams, shorter ranks first
+        QSet<int> ids;        // matches carrying this text
+    };
+
+    static QString documentText(const Match &match);
+
+    QHash<QString, int> m_valueIndex;        // document text -> m_values slot
+    QVector<Value> m_values;                 // emptied slots are reused
+    QVector<int> m_freeValues;
+    QHash<quint64, QVector<int>> m_postings; // trigram -> value slots
+    int m_matchCount = 0;
+};
+
+#endif // SEARCHINDEX_H
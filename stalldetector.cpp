@@ -0,0 +1,403 @@
+#include "stalldetector.h"
+#include "trace.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QThread>
+#include <chrono>
+
+#if defined(Q_OS_LINUX) || defined(Q_OS_MACOS)
+#define PROBALL_STALL_SIGNAL_SAMPLING
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <errno.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#include <dbghelp.h>
+#endif
+
+namespace {
+
+const int maxFrames = 64;
+const int maxSamples = 8;
+const qint64 sampleIntervalNs = 250 * 1000 * 1000;
+
+#if defined(Q_OS_WIN)
+const bool samplingByDefault = true;
+#else
+const bool samplingByDefault = false; // signal sampling is opt-in, see initSampling()
+#endif
+
+// Same clock as the trace spans, so span ages line up
+qint64 monotonicNs()
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+#if defined(PROBALL_STALL_SIGNAL_SAMPLING)
+
+// The GUI thread records its own stack from a signal handler; backtrace()
+// is warmed up first so that the handler never has to load libgcc
+pthread_t guiThread;
+void *sampledFrames[maxFrames];
+std::atomic<int> sampledDepth{-1};
+
+int sampleSignal()
+{
+#ifdef SIGRTMIN
+    return SIGRTMIN + 4;
+#else
+    return SIGPROF;
+#endif
+}
+
+void sampleHandler(int)
+{
+    const int savedErrno = errno;
+    sampledDepth.store(backtrace(sampledFrames, maxFrames), std::memory_order_release);
+    errno = savedErrno;
+}
+
+void initSampling()
+{
+    guiThread = pthread_self();
+    void *warmUp[1];
+    backtrace(warmUp, 1);
+
+    // SA_RESTART resumes plain blocking reads and writes after a sample, but
+    // not poll(), select(), nanosleep() or socket reads with a timeout: those
+    // return EINTR. A blocked ODBC or serial call on the GUI thread can thus
+    // fail because it was sampled, during the very stall being diagnosed,
+    // which is why signal sampling is only on with PROBALL_STALL_SAMPLING=1.
+    struct sigaction action = {};
+    action.sa_handler = sampleHandler;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(sampleSignal(), &action, nullptr) != 0)
+        qDebug() << "Stall detector: cannot install the sampling signal handler";
+}
+
+QString symbolize(void *address)
+{
+    Dl_info info;
+    if (!dladdr(address, &info) || !info.dli_fname)
+        return QString("0x%1").arg(quintptr(address), 0, 16);
+
+    const QString module = QFileInfo(QString::fromLocal8Bit(info.dli_fname)).fileName();
+    if (!info.dli_sname)
+        return QString("%1+0x%2").arg(module).arg(quintptr(address) - quintptr(info.dli_fbase), 0, 16);
+
+    int status = -1;
+    char *demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+    const QString name = QString::fromLocal8Bit(status == 0 && demangled ? demangled : info.dli_sname);
+    free(demangled);
+    return QString("%1!%2+0x%3").arg(module, name).arg(quintptr(address) - quintptr(info.dli_saddr), 0, 16);
+}
+
+QStringList sampleGuiStack()
+{
+    sampledDepth.store(-1, std::memory_order_relaxed);
+    if (pthread_kill(guiThread, sampleSignal()) != 0)
+        return {"(cannot signal the GUI thread)"};
+
+    int depth = -1;
+    for (int waited = 0; waited < 100 && depth < 0; ++waited) {
+        QThread::msleep(1);
+        depth = sampledDepth.load(std::memory_order_acquire);
+    }
+    if (depth < 0)
+        return {"(the GUI thread did not answer the sampling signal)"};
+
+    void *frames[maxFrames];
+    std::copy(sampledFrames, sampledFrames + depth, frames);
+
+    // Frames 0 and 1 are the handler and the kernel's signal trampoline
+    QStringList stack;
+    for (int i = 2; i < depth; ++i)
+        stack << symbolize(frames[i]);
+    return stack;
+}
+
+#elif defined(Q_OS_WIN)
+
+HANDLE guiThread = nullptr;
+
+void initSampling()
+{
+    DuplicateHandle(GetCurrentProcess(), GetCurrentThread(), GetCurrentProcess(), &guiThread,
+                    THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT | THREAD_QUERY_INFORMATION, FALSE, 0);
+
+    // Modules are enumerated now; their symbols load on first use, after the
+    // GUI thread has been resumed. dbghelp is only ever called from the watchdog.
+    SymSetOptions(SYMOPT_UNDNAME | SYMOPT_DEFERRED_LOADS | SYMOPT_LOAD_LINES);
+    if (!SymInitialize(GetCurrentProcess(), nullptr, TRUE))
+        qDebug() << "Stall detector: SymInitialize failed with error" << GetLastError();
+}
+
+QString symbolize(DWORD64 address)
+{
+    HANDLE process = GetCurrentProcess();
+    QString text = QString("0x%1").arg(address, 0, 16);
+
+    IMAGEHLP_MODULE64 module = {};
+    module.SizeOfStruct = sizeof(module);
+    if (SymGetModuleInfo64(process, address, &module))
+        text = QString::fromLocal8Bit(module.ModuleName);
+
+    char buffer[sizeof(SYMBOL_INFO) + 256] = {};
+    SYMBOL_INFO *symbol = reinterpret_cast<SYMBOL_INFO *>(buffer);
+    symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+    symbol->MaxNameLen = 255;
+    DWORD64 displacement = 0;
+    if (SymFromAddr(process, address, &displacement, symbol))
+        text += QString("!%1+0x%2").arg(QString::fromLocal8Bit(symbol->Name)).arg(displacement, 0, 16);
+
+    IMAGEHLP_LINE64 line = {};
+    line.SizeOfStruct = sizeof(line);
+    DWORD lineDisplacement = 0;
+    if (SymGetLineFromAddr64(process, address, &lineDisplacement, &line))
+        text += QString(" (%1:%2)").arg(QString::fromLocal8Bit(line.FileName)).arg(line.LineNumber);
+    return text;
+}
+
+QStringList sampleGuiStack()
+{
+    if (!guiThread)
+        return {"(no handle on the GUI thread)"};
+
+    // Only the raw return addresses are collected while the thread is
+    // suspended; nothing here may wait on a lock the GUI thread could hold
+    DWORD64 frames[maxFrames];
+    int depth = 0;
+    if (SuspendThread(guiThread) == DWORD(-1))
+        return {"(cannot suspend the GUI thread)"};
+
+    CONTEXT context = {};
+    context.ContextFlags = CONTEXT_FULL;
+    if (GetThreadContext(guiThread, &context)) {
+        STACKFRAME64 frame = {};
+        DWORD machine;
+#if defined(_M_X64)
+        machine = IMAGE_FILE_MACHINE_AMD64;
+        frame.AddrPC.Offset = context.Rip;
+        frame.AddrFrame.Offset = context.Rbp;
+        frame.AddrStack.Offset = context.Rsp;
+#elif defined(_M_ARM64)
+        machine = IMAGE_FILE_MACHINE_ARM64;
+        frame.AddrPC.Offset = context.Pc;
+        frame.AddrFrame.Offset = context.Fp;
+        frame.AddrStack.Offset = context.Sp;
+#else
+        machine = IMAGE_FILE_MACHINE_I386;
+        frame.AddrPC.Offset = context.Eip;
+        frame.AddrFrame.Offset = context.Ebp;
+        frame.AddrStack.Offset = context.Esp;
+#endif
+        frame.AddrPC.Mode = AddrModeFlat;
+        frame.AddrFrame.Mode = AddrModeFlat;
+        frame.AddrStack.Mode = AddrModeFlat;
+        while (depth < maxFrames
+               && StackWalk64(machine, GetCurrentProcess(), guiThread, &frame, &context, nullptr,
+                              SymFunctionTableAccess64, SymGetModuleBase64, nullptr)
+               && frame.AddrPC.Offset != 0) {
+            frames[depth++] = frame.AddrPC.Offset;
+        }
+    }
+    ResumeThread(guiThread);
+
+    QStringList stack;
+    for (int i = 0; i < depth; ++i)
+        stack << symbolize(frames[i]);
+    return stack;
+}
+
+#else
+
+void initSampling()
+{
+}
+
+QStringList sampleGuiStack()
+{
+    return {"(stack sampling is not available on this platform)"};
+}
+
+#endif
+
+} // namespace
+
+StallDetector::StallDetector(QObject *parent)
+    : QObject(parent),
+      m_thresholdMs(100),
+      m_sampling(samplingByDefault),
+      m_guiThreadId(QThread::currentThreadId()),
+      m_thread(nullptr),
+      m_stopping(false),
+      m_pingSentNs(0),
+      m_pongNs(0)
+{
+    // Threshold can be tuned per deployment without rebuilding
+    bool ok = false;
+    int envThreshold = qEnvironmentVariableIntValue("PROBALL_STALL_MS", &ok);
+    if (ok && envThreshold >= 0)
+        m_thresholdMs = envThreshold;
+    if (qEnvironmentVariableIsSet("PROBALL_STALL_SAMPLING"))
+        m_sampling = qEnvironmentVariableIntValue("PROBALL_STALL_SAMPLING") != 0;
+
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+    if (dir.isEmpty())
+        dir = QDir::currentPath();
+    QDir().mkpath(dir);
+    m_logPath = QDir(dir).filePath("stalls.log");
+}
+
+StallDetector::~StallDetector()
+{
+    stop();
+}
+
+void StallDetector::setThresholdMs(int ms)
+{
+    m_thresholdMs = ms;
+}
+
+void StallDetector::start()
+{
+    if (m_thread || m_thresholdMs <= 0)
+        return;
+
+    static bool samplingReady = false;
+    if (m_sampling && !samplingReady) {
+        initSampling();
+        samplingReady = true;
+    }
+
+    m_stopping = false;
+    m_pingSentNs.store(0);
+    m_thread = QThread::create([this]() { watch(); });
+    m_thread->setObjectName("stall-watchdog");
+    m_thread->start();
+}
+
+void StallDetector::stop()
+{
+    if (!m_thread)
+        return;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_wake.wakeAll();
+    }
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+}
+
+void StallDetector::watch()
+{
+    const qint64 thresholdNs = qint64(m_thresholdMs) * 1000 * 1000;
+    const int pollMs = qMax(1, m_thresholdMs / 4);
+
+    QList<Sample> samples;
+    qint64 stallSentNs = 0;
+    qint64 nextSampleNs = 0;
+
+    forever {
+        {
+            QMutexLocker locker(&m_mutex);
+            if (!m_stopping)
+                m_wake.wait(&m_mutex, pollMs);
+            if (m_stopping)
+                break;
+        }
+
+        const qint64 now = monotonicNs();
+        const qint64 sent = m_pingSentNs.load(std::memory_order_acquire);
+        if (sent == 0) {
+            // Answered: close the stall that just ended, then ping again
+            if (!samples.isEmpty()) {
+                logEnd(m_pongNs.load(std::memory_order_relaxed) - stallSentNs);
+                samples.clear();
+            }
+            m_pingSentNs.store(now, std::memory_order_relaxed);
+            QMetaObject::invokeMethod(this, [this]() {
+                m_pongNs.store(monotonicNs(), std::memory_order_relaxed);
+                m_pingSentNs.store(0, std::memory_order_release);
+            }, Qt::QueuedConnection);
+            continue;
+        }
+
+        if (now - sent < thresholdNs || (!samples.isEmpty() && (now < nextSampleNs || samples.size() >= maxSamples)))
+            continue;
+
+        // Logged as it happens: a freeze that never ends, or that the
+        // operator kills, still leaves its stacks in the log
+        if (samples.isEmpty()) {
+            stallSentNs = sent;
+            const char *spanName = nullptr;
+            qint64 spanAgeNs = 0;
+#ifdef PROBALL_TRACING
+            const Trace::ActiveSpan span = Trace::activeSpan(m_guiThreadId);
+            if (span.name) {
+                spanName = span.name;
+                spanAgeNs = now - span.sinceNs;
+            }
+#endif
+            logStart(now - sent, spanName, spanAgeNs);
+        }
+        samples.append({now - sent, m_sampling ? sampleGuiStack() : QStringList()});
+        logSample(samples.last(), samples.size() > 1 ? &samples[samples.size() - 2] : nullptr);
+        nextSampleNs = now + sampleIntervalNs;
+    }
+}
+
+void StallDetector::logStart(qint64 elapsedNs, const char *spanName, qint64 spanAgeNs) const
+{
+    QString text = QDateTime::currentDateTime().toString(Qt::ISODateWithMs)
+                 + QString(" GUI thread stalled, no answer for %1 ms").arg(elapsedNs / 1e6, 0, 'f', 1);
+    if (spanName)
+        text += QString(" in span %1 (open for %2 ms)").arg(QString::fromUtf8(spanName)).arg(spanAgeNs / 1e6, 0, 'f', 1);
+    appendLog(text);
+}
+
+void StallDetector::logSample(const Sample &sample, const Sample *previous) const
+{
+    QString text = QString("  sample at +%1 ms").arg(sample.offsetNs / 1e6, 0, 'f', 1);
+    if (sample.frames.isEmpty()) {
+        text += ": stack sampling is off (PROBALL_STALL_SAMPLING=1 turns it on)";
+    } else if (previous && sample.frames == previous->frames) {
+        text += ": same stack";
+    } else {
+        text += ':';
+        for (int frame = 0; frame < sample.frames.size(); ++frame)
+            text += QString("\n    #%1 %2").arg(frame).arg(sample.frames[frame]);
+    }
+    appendLog(text);
+}
+
+void StallDetector::logEnd(qint64 durationNs) const
+{
+    appendLog(QDateTime::currentDateTime().toString(Qt::ISODateWithMs)
+              + QString(" GUI thread stall ended after %1 ms").arg(durationNs / 1e6, 0, 'f', 1));
+}
+
+void StallDetector::appendLog(const QString &text) const
+{
+    qDebug().noquote() << text;
+
+    // Reopened per entry so that every line is on disk before the next one
+    QFile file(m_logPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        qDebug() << "Cannot open stall log:" << file.errorString();
+        return;
+    }
+    file.write(text.toUtf8() + '\n');
+}
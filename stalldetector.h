@@ -0,0 +1,69 @@
+#ifndef STALLDETECTOR_H
+#define STALLDETECTOR_H
+
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QWaitCondition>
+#include <atomic>
+
+class QThread;
+
+// Watchdog for the GUI event loop. A watchdog thread posts a ping to the GUI
+// thread and, when it is not answered within the threshold, samples the GUI
+// thread's stack (a signal and backtrace() on Linux and macOS, SuspendThread
+// and StackWalk64 on Windows) about every quarter second while it lasts.
+// The stall is logged when detected, with the trace span that was open in
+// tracing builds, then each stack as it is taken and finally the duration
+// once the loop answers, so freezes that never end are on record too.
+//
+// The threshold comes from PROBALL_STALL_MS (default 100 ms, 0 disables) and
+// reports go to qDebug() and to stalls.log next to the slow query log.
+// PROBALL_STALL_SAMPLING turns stack sampling on (1) or off (0). It is off
+// by default on Linux and macOS: the sampling signal makes poll(), select()
+// and timed socket reads on the GUI thread fail with EINTR, so it can break
+// a blocked ODBC or serial call; stalls are still logged with their span.
+class StallDetector : public QObject
+{
+    Q_OBJECT
+public:
+    explicit StallDetector(QObject *parent = nullptr); // on the GUI thread
+    ~StallDetector();
+
+    void start();
+    void stop();
+
+    int thresholdMs() const { return m_thresholdMs; }
+    void setThresholdMs(int ms); // takes effect on the next start()
+    QString logPath() const { return m_logPath; }
+
+private:
+    struct Sample
+    {
+        qint64 offsetNs; // since the unanswered ping was posted
+        QStringList frames;
+    };
+
+    void watch();
+    void logStart(qint64 elapsedNs, const char *spanName, qint64 spanAgeNs) const;
+    void logSample(const Sample &sample, const Sample *previous) const;
+    void logEnd(qint64 durationNs) const;
+    void appendLog(const QString &text) const;
+
+    int m_thresholdMs;
+    bool m_sampling; // stack samples as well as durations
+    QString m_logPath;
+    Qt::HANDLE m_guiThreadId;
+    QThread *m_thread;
+
+    QMutex m_mutex;
+    QWaitCondition m_wake;
+    bool m_stopping;
+
+    std::atomic<qint64> m_pingSentNs; // 0 once the GUI thread has answered
+    std::atomic<qint64> m_pongNs;
+};
+
+#endif // STALLDETECTOR_H
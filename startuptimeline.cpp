@@ -0,0 +1,119 @@
+#include "startuptimeline.h"
+#include <QDebug>
+#include <QHash>
+#include <QThread>
+#include <algorithm>
+
+StartupTimeline &StartupTimeline::instance()
+{
+    static StartupTimeline timeline;
+    return timeline;
+}
+
+qint64 StartupTimeline::budgetMs(const QString &phase)
+{
+    // Milestones count from start(); phases from their own begin()
+    static const QHash<QString, qint64> budgets = {
+        {"window", 250},
+        {"first-interaction", 500},
+        {"gates.scan", 500},
+        {"db.connect", 2000},
+        {"db.load", 1500},
+        {"model.select", 300},
+        {"ui.fill", 300},
+        {"ready", 3000},
+    };
+    return budgets.value(phase, -1);
+}
+
+QString StartupTimeline::currentThreadName()
+{
+    QThread *thread = QThread::currentThread();
+    if (!thread->objectName().isEmpty())
+        return thread->objectName();
+    return thread->isMainThread() ? QString("main") : QString("worker");
+}
+
+void StartupTimeline::start()
+{
+    QMutexLocker locker(&m_mutex);
+    m_clock.start();
+    m_phases.clear();
+    m_finished = false;
+}
+
+void StartupTimeline::begin(const QString &phase)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_clock.isValid() || m_finished)
+        return;
+    Phase entry;
+    entry.name = phase;
+    entry.thread = currentThreadName();
+    entry.beginMs = m_clock.elapsed();
+    m_phases.append(entry);
+}
+
+void StartupTimeline::end(const QString &phase)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_clock.isValid() || m_finished)
+        return;
+    for (int i = m_phases.size() - 1; i >= 0; --i) {
+        if (m_phases[i].name == phase && m_phases[i].endMs < 0) {
+            m_phases[i].endMs = m_clock.elapsed();
+            report(m_phases[i]);
+            return;
+        }
+    }
+}
+
+void StartupTimeline::mark(const QString &milestone)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_clock.isValid() || m_finished)
+        return;
+    Phase entry;
+    entry.name = milestone;
+    entry.thread = currentThreadName();
+    entry.beginMs = 0;
+    entry.endMs = m_clock.elapsed();
+    m_phases.append(entry);
+    report(entry);
+}
+
+void StartupTimeline::report(const Phase &phase) const
+{
+    const qint64 took = phase.endMs - phase.beginMs;
+    const qint64 budget = budgetMs(phase.name);
+    if (budget >= 0 && took > budget)
+        qWarning().noquote() << QString("Startup: %1 took %2 ms, over its %3 ms budget [%4]")
+                                    .arg(phase.name).arg(took).arg(budget).arg(phase.thread);
+    else
+        qDebug().noquote() << QString("Startup: %1 took %2 ms [%3]").arg(phase.name).arg(took).arg(phase.thread);
+}
+
+void StartupTimeline::finish()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_clock.isValid() || m_finished)
+        return;
+    m_finished = true;
+
+    QList<Phase> phases = m_phases;
+    std::stable_sort(phases.begin(), phases.end(), [](const Phase &a, const Phase &b) {
+        return a.beginMs < b.beginMs;
+    });
+
+    // One line per phase: where it sat on the timeline and what it cost
+    qDebug().noquote() << QString("Startup timeline (%1 ms):").arg(m_clock.elapsed());
+    for (const Phase &phase : std::as_const(phases)) {
+        const qint64 budget = budgetMs(phase.name);
+        qDebug().noquote() << QString("  %1 %2..%3 ms %4%5")
+                                  .arg(phase.name, -18)
+                                  .arg(phase.beginMs, 6)
+                                  .arg(phase.endMs < 0 ? QString("unfinished") : QString::number(phase.endMs), 6)
+                                  .arg(phase.thread)
+                                  .arg(budget >= 0 ? QString(" (budget %1 ms)").arg(budget) : QString());
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef STARTUPTIMELINE_H
+#define STARTUPTIMELINE_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+// Times the phases of application startup against fixed budgets. Phases may
+// overlap and run on any thread; each one is logged as it ends, with a
+// warning when it overruns, and finish() prints the whole timeline once.
+class StartupTimeline
+{
+public:
+    static StartupTimeline &instance();
+
+    void start();                          // first thing in main()
+    void begin(const QString &phase);
+    void end(const QString &phase);
+    void mark(const QString &milestone);   // instant, measured from start()
+    void finish();
+
+    qint64 elapsedMs() const { return m_clock.isValid() ? m_clock.elapsed() : 0; }
+
+private:
+    StartupTimeline() = default;
+
+    struct Phase
+    {
+        QString name;
+        QString thread;
+        qint64 beginMs = -1;
+        qint64 endMs = -1;
+    };
+
+    static qint64 budgetMs(const QString &phase);
+    static QString currentThreadName();
+    void report(const Phase &phase) const;
+
+    mutable QMutex m_mutex;
+    QElapsedTimer m_clock;
+    QList<Phase> m_phases;
+    bool m_finished = false;
+};
+
+// Times one phase for the lifetime of the object
+class StartupPhase
+{
+public:
+    explicit StartupPhase(const QString &phase) : m_phase(phase) { StartupTimeline::instance().begin(m_phase); }
+    ~StartupPhase() { StartupTimeline::instance().end(m_phase); }
+
+private:
+    QString m_phase;
+};
+
+#endif // STARTUPTIMELINE_H
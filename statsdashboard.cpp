@@ -0,0 +1,266 @@
+#include "statsdashboard.h"
+#include <QHBoxLayout>
+#include <QPushButton>
+#include <QVBoxLayout>
+#include <QtMath>
+
+namespace {
+
+// Match types shown when grouping by type, as in the original statistics
+const QStringList shownTypes = {"amicale", "championnat", "compétitif"};
+
+// Grid geometry shared by every grouping
+const int MAX_DIAMETER = 200;
+const int SPACING = 50;
+
+} // namespace
+
+StatsDashboard::StatsDashboard(AttendanceAggregates *aggregates, MatchStore *store, QWidget *parent)
+    : QDialog(parent), m_aggregates(aggregates), m_store(store), m_grouping(-1)
+{
+    setWindowTitle("Holographic Attendance Statistics");
+    setMinimumSize(800, 600);
+    setModal(false);
+    setStyleSheet("background-color: #0a192f;"); // Dark blue background for hologram effect
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+
+    // Add title
+    m_titleLabel = new QLabel("Holographic Attendance per Match Type", this);
+    QFont titleFont = m_titleLabel->font();
+    titleFont.setBold(true);
+    titleFont.setPointSize(16);
+    m_titleLabel->setFont(titleFont);
+    m_titleLabel->setAlignment(Qt::AlignCenter);
+    m_titleLabel->setStyleSheet("color: #00e5ff; margin: 10px;"); // Cyan text for hologram feel
+    layout->addWidget(m_titleLabel);
+
+    // Grouping selector: from a handful of match types to thousands of dates
+    QHBoxLayout *controlsLayout = new QHBoxLayout();
+    QLabel *groupLabel = new QLabel("Group by:", this);
+    groupLabel->setStyleSheet("color: #00e5ff;");
+    m_groupCombo = new QComboBox(this);
+    m_groupCombo->addItems({"Match Type", "Venue", "Date", "Venue × Month"});
+    m_groupCombo->setStyleSheet("background-color: #003366; color: white;");
+    QLabel *hintLabel = new QLabel("Live - wheel to zoom, drag to pan", this);
+    hintLabel->setStyleSheet("color: #5f8fb0;");
+    controlsLayout->addWidget(groupLabel);
+    controlsLayout->addWidget(m_groupCombo);
+    controlsLayout->addStretch(1);
+    controlsLayout->addWidget(hintLabel);
+    layout->addLayout(controlsLayout);
+
+    // Zoomable, pannable view; the scene's BSP index culls everything outside the viewport
+    m_view = new HologramView(this);
+    m_scene = new QGraphicsScene(m_view);
+    m_scene->setItemIndexMethod(QGraphicsScene::BspTreeIndex);
+    m_view->setScene(m_scene);
+    m_view->setRenderHint(QPainter::Antialiasing);
+    m_view->setBackgroundBrush(QBrush(QColor("#0a192f"))); // Dark blue background
+    m_view->setFrameStyle(QFrame::NoFrame);
+    HologramClock::shared()->attachView(m_view); // glow pauses while the dashboard is hidden
+    layout->addWidget(m_view);
+
+    // Add export buttons
+    QPushButton *exportButton = new QPushButton("Export to PDF", this);
+    exportButton->setStyleSheet("background-color: #003366; color: white; padding: 8px; border-radius: 5px;");
+    connect(exportButton, &QPushButton::clicked, this, [this]() { emit exportPdfRequested(m_scene); });
+    layout->addWidget(exportButton);
+
+    QPushButton *svgButton = new QPushButton("Export to SVG", this);
+    svgButton->setStyleSheet("background-color: #003366; color: white; padding: 8px; border-radius: 5px;");
+    connect(svgButton, &QPushButton::clicked, this, [this]() { emit exportSvgRequested(m_scene); });
+    layout->addWidget(svgButton);
+
+    // Live updates
+    m_syncTimer.setSingleShot(true);
+    m_syncTimer.setInterval(100);
+    connect(&m_syncTimer, &QTimer::timeout, this, &StatsDashboard::sync);
+    connect(m_aggregates, &AttendanceAggregates::changed, this, &StatsDashboard::typeChanged);
+    connect(m_aggregates, &AttendanceAggregates::rebuilt, this, [this]() {
+        if (groupsByType())
+            reload();
+    });
+    connect(m_store, &MatchStore::matchInserted, this, &StatsDashboard::matchInserted);
+    connect(m_store, &MatchStore::matchUpdated, this, &StatsDashboard::matchUpdated);
+    connect(m_store, &MatchStore::matchRemoved, this, &StatsDashboard::matchRemoved);
+    connect(m_store, &MatchStore::reloaded, this, [this]() {
+        if (!groupsByType())
+            reload();
+    });
+
+    connect(m_groupCombo, &QComboBox::currentIndexChanged, this, &StatsDashboard::setGrouping);
+    setGrouping(0);
+}
+
+void StatsDashboard::setGrouping(int grouping)
+{
+    if (grouping == m_grouping)
+        return;
+    m_grouping = grouping;
+    m_titleLabel->setText("Holographic Attendance per " + m_groupCombo->itemText(grouping));
+
+    m_groupBy.clear();
+    if (grouping == 1)
+        m_groupBy << AttendanceCube::Venue;
+    else if (grouping == 2)
+        m_groupBy << AttendanceCube::Day;
+    else if (grouping == 3)
+        m_groupBy << AttendanceCube::Venue << AttendanceCube::Month;
+
+    // A new grouping is a new picture: start from an empty scene
+    qDeleteAll(m_bars);
+    m_bars.clear();
+    m_scene->setSceneRect(QRectF());
+    m_view->resetTransform();
+
+    reload();
+    sync();
+
+    // Large grids open zoomed out; bars draw as simple marks until zoomed in
+    if (m_bars.size() > 9)
+        m_view->fitScene();
+}
+
+void StatsDashboard::reload()
+{
+    m_totals.clear();
+    if (groupsByType()) {
+        for (const TypeAttendance &stats : m_aggregates->byType()) {
+            Totals &totals = m_totals[stats.type];
+            totals.matches = stats.matchCount;
+            totals.attendanceCount = stats.attendanceCount;
+            totals.attendanceSum = stats.attendanceSum;
+        }
+    } else {
+        const QHash<QString, CubeCell> cells = AttendanceCube::rollup(m_store->matches(), m_groupBy);
+        for (auto it = cells.cbegin(); it != cells.cend(); ++it) {
+            Totals &totals = m_totals[it.key()];
+            totals.matches = it->matches;
+            totals.attendanceCount = it->attendanceCount;
+            totals.attendanceSum = it->attendanceSum;
+        }
+    }
+    scheduleSync();
+}
+
+void StatsDashboard::typeChanged(const QString &type)
+{
+    if (!groupsByType())
+        return;
+
+    // The aggregates already hold the new totals for this type
+    const TypeAttendance stats = m_aggregates->forType(type);
+    if (stats.matchCount <= 0) {
+        m_totals.remove(type);
+    } else {
+        Totals &totals = m_totals[type];
+        totals.matches = stats.matchCount;
+        totals.attendanceCount = stats.attendanceCount;
+        totals.attendanceSum = stats.attendanceSum;
+    }
+    scheduleSync();
+}
+
+void StatsDashboard::matchInserted(const Match &match)
+{
+    if (!groupsByType())
+        adjust(match, +1);
+}
+
+void StatsDashboard::matchUpdated(const Match &before, const Match &after)
+{
+    if (groupsByType())
+        return;
+    adjust(before, -1);
+    adjust(after, +1);
+}
+
+void StatsDashboard::matchRemoved(const Match &match)
+{
+    if (!groupsByType())
+        adjust(match, -1);
+}
+
+void StatsDashboard::adjust(const Match &match, int delta)
+{
+    const QString key = AttendanceCube::keyFor(match, m_groupBy);
+    Totals &totals = m_totals[key];
+    totals.matches += delta;
+    if (match.hasSpectateurs()) {
+        totals.attendanceCount += delta;
+        totals.attendanceSum += qint64(delta) * match.spectateurs;
+    }
+    if (totals.matches <= 0)
+        m_totals.remove(key);
+    scheduleSync();
+}
+
+void StatsDashboard::scheduleSync()
+{
+    if (!m_syncTimer.isActive())
+        m_syncTimer.start();
+}
+
+void StatsDashboard::sync()
+{
+    m_syncTimer.stop();
+
+    // Groups to show, in grid order
+    QStringList keys;
+    double maxAttendance = 0;
+    for (auto it = m_totals.cbegin(); it != m_totals.cend(); ++it) {
+        const bool shown = groupsByType() ? shownTypes.contains(it.key()) && it->matches > 0
+                                          : it->attendanceCount > 0;
+        if (!shown)
+            continue;
+        keys << it.key();
+        maxAttendance = qMax(maxAttendance, it->average());
+    }
+
+    // Remove bars whose group has gone
+    const QSet<QString> keySet(keys.cbegin(), keys.cend());
+    for (auto it = m_bars.begin(); it != m_bars.end();) {
+        if (!keySet.contains(it.key())) {
+            delete it.value();
+            it = m_bars.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // Calculate layout - a grid, roughly square once there are many groups
+    const int itemsPerRow = keys.size() <= 9 ? 3 : qCeil(qSqrt(double(keys.size())));
+    // Per-frame glow and reflections only pay off for small scenes
+    const bool detailed = keys.size() <= 60;
+
+    QRectF bounds;
+    for (int i = 0; i < keys.size(); ++i) {
+        const Totals &totals = m_totals[keys[i]];
+        const double average = totals.average();
+
+        // Size proportional to attendance, position on the grid
+        double sizeRatio = maxAttendance > 0 ? average / maxAttendance : 0.0;
+        int diameter = qMax(80, int(sizeRatio * MAX_DIAMETER));
+        int xCenter = (i % itemsPerRow) * (MAX_DIAMETER + SPACING) + MAX_DIAMETER / 2;
+        int yCenter = (i / itemsPerRow) * (MAX_DIAMETER + SPACING) + MAX_DIAMETER / 2;
+        const QRectF rect(xCenter - diameter / 2, yCenter - diameter / 2, diameter, diameter);
+        bounds |= rect.adjusted(0, 0, 0, diameter / 5 + 10); // room for the reflection
+
+        HologramBar *bar = m_bars.value(keys[i]);
+        if (!bar) {
+            bar = new HologramBar(keys[i], average, int(totals.matches));
+            bar->setBarRect(rect);
+            m_scene->addItem(bar);
+            m_bars.insert(keys[i], bar);
+        } else {
+            // Only bars whose value or slot changed actually animate
+            bar->animateTo(average, int(totals.matches), rect);
+        }
+        bar->setGlowEnabled(detailed);
+        bar->setReflectionEnabled(detailed);
+    }
+
+    // Grow the scene as needed but never shrink it under the operator's view
+    m_scene->setSceneRect(m_scene->sceneRect().united(bounds.adjusted(-50, -50, 50, 50)));
+}
@@ -0,0 +1,70 @@
+#ifndef STATSDASHBOARD_H
+#define STATSDASHBOARD_H
+
+#include <QComboBox>
+#include <QDialog>
+#include <QGraphicsScene>
+#include <QHash>
+#include <QLabel>
+#include <QMap>
+#include <QSet>
+#include <QTimer>
+#include "attendancecube.h"
+#include "attendancestats.h"
+#include "hologrambar.h"
+#include "matches.h"
+
+// Non-modal holographic attendance dashboard. It keeps one bar per group
+// and follows the aggregates and the match store: a change re-totals only its
+// group and animates only the bars whose value or position moved. Bars are
+// added and removed in place, the scene is never rebuilt for live updates.
+class StatsDashboard : public QDialog
+{
+    Q_OBJECT
+public:
+    StatsDashboard(AttendanceAggregates *aggregates, MatchStore *store, QWidget *parent = nullptr);
+
+    bool hasData() const { return !m_bars.isEmpty(); }
+    QGraphicsScene *scene() const { return m_scene; }
+
+signals:
+    void exportPdfRequested(QGraphicsScene *scene);
+    void exportSvgRequested(QGraphicsScene *scene);
+
+private slots:
+    void setGrouping(int grouping);
+    void typeChanged(const QString &type);
+    void matchInserted(const Match &match);
+    void matchUpdated(const Match &before, const Match &after);
+    void matchRemoved(const Match &match);
+    void reload();
+    void sync();
+
+private:
+    struct Totals
+    {
+        qint64 matches = 0;
+        qint64 attendanceCount = 0;
+        qint64 attendanceSum = 0;
+        double average() const { return attendanceCount > 0 ? double(attendanceSum) / attendanceCount : 0.0; }
+    };
+
+    bool groupsByType() const { return m_grouping == 0; }
+    void adjust(const Match &match, int delta);
+    void scheduleSync();
+
+    AttendanceAggregates *m_aggregates;
+    MatchStore *m_store;
+    QLabel *m_titleLabel;
+    QComboBox *m_groupCombo;
+    HologramView *m_view;
+    QGraphicsScene *m_scene;
+
+    int m_grouping;
+    QList<AttendanceCube::Dimension> m_groupBy; // empty when grouping by type
+    QMap<QString, Totals> m_totals;             // ordered: grid order
+    QHash<QString, HologramBar *> m_bars;
+    QTimer m_syncTimer;                         // coalesces bursts of changes
+};
+
+#endif // STATSDASHBOARD_H
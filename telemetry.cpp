@@ -0,0 +1,155 @@
+#include "telemetry.h"
+#include "gatemanager.h"
+#include <algorithm>
+
+namespace {
+
+const int drainIntervalMs = 250;
+
+} // namespace
+
+OccupancyTracker::OccupancyTracker(GateManager *gates, QObject *parent)
+    : QObject(parent), m_gates(gates), m_capacity(-1), m_firstEventMs(-1), m_lostFrames(0)
+{
+    m_timer.setInterval(drainIntervalMs);
+    connect(&m_timer, &QTimer::timeout, this, &OccupancyTracker::drain);
+    m_timer.start();
+}
+
+void OccupancyTracker::reset()
+{
+    // Whatever is still queued belongs to the old count
+    if (m_gates) {
+        for (BarrierLink *link : m_gates->gates())
+            link->telemetry()->drain([](const TurnstileEvent &) {});
+    }
+    m_state.clear();
+    m_firstEventMs = -1;
+    m_lostFrames = 0;
+    emit updated();
+}
+
+void OccupancyTracker::drain()
+{
+    if (!m_gates)
+        return;
+
+    const QList<BarrierLink *> links = m_gates->gates();
+    for (BarrierLink *link : links) {
+        // Until the handshake is seen here, gateId() is only the port fallback;
+        // the events stay in the ring and are counted under the real id
+        if (!link->isIdentified())
+            continue;
+        GateState *state = nullptr;
+        link->telemetry()->drain([this, link, &state](const TurnstileEvent &event) {
+            if (!state)
+                state = &m_state[link->gateId()];
+            add(*state, event);
+        });
+    }
+    // Rates decay even without new events, so refresh on every tick
+    emit updated();
+}
+
+void OccupancyTracker::add(GateState &state, const TurnstileEvent &event)
+{
+    if (m_firstEventMs < 0)
+        m_firstEventMs = event.atMs;
+    m_lostFrames += event.lostFrames;
+    state.entries += event.entries;
+    state.exits += event.exits;
+
+    const qint64 second = event.atMs / 1000;
+    const int bucket = int(second % windowSeconds);
+    if (state.bucketSecond[bucket] != second) {
+        state.bucketSecond[bucket] = second;
+        state.bucketEntries[bucket] = 0;
+        state.bucketExits[bucket] = 0;
+    }
+    state.bucketEntries[bucket] += event.entries;
+    state.bucketExits[bucket] += event.exits;
+}
+
+void OccupancyTracker::windowTotals(const GateState &state, qint64 nowSecond, int *entries, int *exits) const
+{
+    *entries = 0;
+    *exits = 0;
+    for (int i = 0; i < windowSeconds; ++i) {
+        if (nowSecond - state.bucketSecond[i] < windowSeconds) {
+            *entries += state.bucketEntries[i];
+            *exits += state.bucketExits[i];
+        }
+    }
+}
+
+qint64 OccupancyTracker::occupancy() const
+{
+    qint64 total = 0;
+    for (const GateState &state : m_state)
+        total += state.entries - state.exits;
+    return qMax<qint64>(0, total);
+}
+
+int OccupancyTracker::entriesPerMinute() const
+{
+    const qint64 nowSecond = telemetryClockMs() / 1000;
+    int total = 0;
+    for (const GateState &state : m_state) {
+        int entries, exits;
+        windowTotals(state, nowSecond, &entries, &exits);
+        total += entries;
+    }
+    return total;
+}
+
+int OccupancyTracker::secondsToCapacity() const
+{
+    if (m_capacity < 0 || m_firstEventMs < 0)
+        return -1;
+    const qint64 remaining = m_capacity - occupancy();
+    if (remaining <= 0)
+        return 0;
+
+    // Net inflow over the window, or over the time since the first event
+    const qint64 nowMs = telemetryClockMs();
+    const qint64 nowSecond = nowMs / 1000;
+    qint64 net = 0;
+    for (const GateState &state : m_state) {
+        int entries, exits;
+        windowTotals(state, nowSecond, &entries, &exits);
+        net += entries - exits;
+    }
+    const double seconds = qBound(1.0, (nowMs - m_firstEventMs) / 1000.0, double(windowSeconds));
+    const double perSecond = net / seconds;
+    if (perSecond <= 0.0)
+        return -1;
+    return int(remaining / perSecond);
+}
+
+QList<OccupancyTracker::GateStats> OccupancyTracker::gateStats() const
+{
+    const qint64 nowSecond = telemetryClockMs() / 1000;
+    QList<GateStats> stats;
+    for (auto it = m_state.cbegin(); it != m_state.cend(); ++it) {
+        GateStats gate;
+        gate.gateId = it.key();
+        gate.entries = it->entries;
+        gate.exits = it->exits;
+        windowTotals(*it, nowSecond, &gate.entriesPerMinute, &gate.exitsPerMinute);
+        stats.append(gate);
+    }
+    std::sort(stats.begin(), stats.end(), [](const GateStats &a, const GateStats &b) {
+        return a.gateId < b.gateId;
+    });
+    return stats;
+}
+
+qint64 OccupancyTracker::droppedEvents() const
+{
+    qint64 dropped = 0;
+    if (m_gates) {
+        for (BarrierLink *link : m_gates->gates())
+            dropped += link->telemetry()->dropped();
+    }
+    return dropped;
+}
@@ -0,0 +1,136 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QPointer>
+#include <QString>
+#include <QTimer>
+#include <atomic>
+#include <chrono>
+
+class GateManager;
+
+// Milliseconds on a monotonic clock shared by all gate threads
+inline qint64 telemetryClockMs()
+{
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// One Telemetry frame from a gate: turnstile counts since its previous frame
+struct TurnstileEvent
+{
+    qint64 atMs;
+    quint16 entries;
+    quint16 exits;
+    quint16 lostFrames; // sequence gap before this frame
+};
+
+// Lock-free ring for exactly one producer thread and one consumer thread.
+// push() never blocks; when the consumer falls behind by Size items the
+// new item is dropped and counted.
+template <typename T, int Size>
+class SpscRing
+{
+    static_assert((Size & (Size - 1)) == 0, "Size must be a power of two");
+
+public:
+    bool push(const T &item)
+    {
+        const quint32 head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) == quint32(Size)) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        m_items[head & (Size - 1)] = item;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <typename Consume>
+    int drain(Consume &&consume)
+    {
+        quint32 tail = m_tail.load(std::memory_order_relaxed);
+        const quint32 head = m_head.load(std::memory_order_acquire);
+        const int count = int(head - tail);
+        for (; tail != head; ++tail)
+            consume(m_items[tail & (Size - 1)]);
+        m_tail.store(tail, std::memory_order_release);
+        return count;
+    }
+
+    quint32 dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    // Separate cache lines so that the two threads do not false-share
+    alignas(64) std::atomic<quint32> m_head{0};
+    alignas(64) std::atomic<quint32> m_tail{0};
+    alignas(64) std::atomic<quint32> m_dropped{0};
+    T m_items[Size];
+};
+
+using TelemetryRing = SpscRing<TurnstileEvent, 4096>;
+
+// Folds the turnstile streams of all gates into occupancy figures. The gate
+// threads only push into their rings; this object drains them on a GUI
+// timer a few times per second, so the GUI thread does a fixed amount of
+// work per tick however many events arrive.
+class OccupancyTracker : public QObject
+{
+    Q_OBJECT
+public:
+    struct GateStats
+    {
+        QString gateId;
+        qint64 entries = 0;
+        qint64 exits = 0;
+        int entriesPerMinute = 0;
+        int exitsPerMinute = 0;
+    };
+
+    explicit OccupancyTracker(GateManager *gates, QObject *parent = nullptr);
+
+    void setCapacity(int capacity) { m_capacity = capacity; }
+    int capacity() const { return m_capacity; }
+    void reset();
+
+    qint64 occupancy() const;
+    int entriesPerMinute() const;
+    int secondsToCapacity() const; // -1 if the crowd is not growing
+    QList<GateStats> gateStats() const;
+    qint64 droppedEvents() const;
+    qint64 lostFrames() const { return m_lostFrames; }
+
+signals:
+    void updated();
+
+private slots:
+    void drain();
+
+private:
+    static const int windowSeconds = 60;
+
+    struct GateState
+    {
+        qint64 entries = 0;
+        qint64 exits = 0;
+        // One bucket per second of the sliding window
+        qint64 bucketSecond[windowSeconds] = {};
+        int bucketEntries[windowSeconds] = {};
+        int bucketExits[windowSeconds] = {};
+    };
+
+    void add(GateState &state, const TurnstileEvent &event);
+    void windowTotals(const GateState &state, qint64 nowSecond, int *entries, int *exits) const;
+
+    QPointer<GateManager> m_gates;
+    QTimer m_timer;
+    QHash<QString, GateState> m_state; // by gate id, survives unplugging
+    int m_capacity;
+    qint64 m_firstEventMs;
+    qint64 m_lostFrames;
+};
+
+#endif // TELEMETRY_H
@@ -0,0 +1,282 @@
+#include "trace.h"
+
+#ifdef PROBALL_TRACING
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QSaveFile>
+#include <QThread>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+
+namespace Trace {
+
+namespace {
+
+const int detailSize = 56;
+const int chunkEvents = 1024;
+const int maxChunksPerThread = 256; // about 20 MB per thread, then spans are dropped
+
+struct Event
+{
+    const char *name;
+    qint64 beginNs;
+    qint64 durationNs;
+    char detail[detailSize];
+};
+
+// Filled by one thread; count is published after the event is written, so
+// the dumper only ever reads complete events
+struct Chunk
+{
+    Event events[chunkEvents];
+    std::atomic<int> count{0};
+    std::atomic<Chunk *> next{nullptr};
+};
+
+struct ThreadBuffer
+{
+    int index = 0;
+    Qt::HANDLE threadId = nullptr;
+    QByteArray threadName;
+    Chunk *head = nullptr;
+    Chunk *tail = nullptr; // writer only
+    int chunks = 0;        // writer only
+    std::atomic<qint64> dropped{0};
+
+    // Innermost open span, published for other threads (the stall detector)
+    std::atomic<const char *> spanName{nullptr};
+    std::atomic<qint64> spanSinceNs{0};
+};
+
+// Buffers outlive their threads so that pool threads still show up in the dump
+QMutex registryMutex;
+QList<ThreadBuffer *> registry;
+thread_local ThreadBuffer *threadBuffer = nullptr;
+
+const qint64 originNs = nowNs();
+
+ThreadBuffer *currentBuffer()
+{
+    if (threadBuffer)
+        return threadBuffer;
+
+    ThreadBuffer *buffer = new ThreadBuffer;
+    buffer->threadId = QThread::currentThreadId();
+    QThread *thread = QThread::currentThread();
+    buffer->threadName = thread->objectName().toUtf8();
+    if (buffer->threadName.isEmpty())
+        buffer->threadName = thread->isMainThread() ? QByteArray("main") : QByteArray("worker");
+    buffer->head = buffer->tail = new Chunk;
+    buffer->chunks = 1;
+
+    QMutexLocker locker(&registryMutex);
+    buffer->index = int(registry.size()) + 1;
+    registry.append(buffer);
+    threadBuffer = buffer;
+    return buffer;
+}
+
+void append(const char *name, const char *detail, int detailLength, qint64 beginNs, qint64 durationNs)
+{
+    ThreadBuffer *buffer = currentBuffer();
+    Chunk *chunk = buffer->tail;
+    int count = chunk->count.load(std::memory_order_relaxed);
+    if (count == chunkEvents) {
+        if (buffer->chunks == maxChunksPerThread) {
+            buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        Chunk *fresh = new Chunk;
+        chunk->next.store(fresh, std::memory_order_release);
+        buffer->tail = chunk = fresh;
+        buffer->chunks++;
+        count = 0;
+    }
+
+    Event &event = chunk->events[count];
+    event.name = name;
+    event.beginNs = beginNs;
+    event.durationNs = durationNs;
+    int length = qMin(detailLength, detailSize - 1);
+    // Never cut a UTF-8 sequence in half
+    if (length < detailLength) {
+        while (length > 0 && (static_cast<unsigned char>(detail[length]) & 0xC0) == 0x80)
+            length--;
+    }
+    if (length > 0)
+        memcpy(event.detail, detail, size_t(length));
+    event.detail[length] = '\0';
+    chunk->count.store(count + 1, std::memory_order_release);
+}
+
+// The JSON is assembled as UTF-8 bytes; names and details already are UTF-8
+void appendJsonString(QByteArray &out, const char *text)
+{
+    out += '"';
+    for (const char *c = text; *c; ++c) {
+        const unsigned char ch = static_cast<unsigned char>(*c);
+        if (ch == '"' || ch == '\\') {
+            out += '\\';
+            out += char(ch);
+        } else if (ch < 0x20) {
+            out += "\\u00";
+            out += QByteArray::number(ch, 16).rightJustified(2, '0');
+        } else {
+            out += char(ch);
+        }
+    }
+    out += '"';
+}
+
+} // namespace
+
+qint64 nowNs()
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void complete(const char *name, const QString &detail, qint64 beginNs, qint64 durationNs)
+{
+    const QByteArray utf8 = detail.toUtf8();
+    append(name, utf8.constData(), int(utf8.size()), beginNs, durationNs);
+}
+
+namespace {
+
+ActiveSpan enterSpan(const char *name, qint64 beginNs)
+{
+    ThreadBuffer *buffer = currentBuffer();
+    ActiveSpan outer;
+    outer.name = buffer->spanName.load(std::memory_order_relaxed);
+    outer.sinceNs = buffer->spanSinceNs.load(std::memory_order_relaxed);
+    buffer->spanSinceNs.store(beginNs, std::memory_order_relaxed);
+    buffer->spanName.store(name, std::memory_order_release);
+    return outer;
+}
+
+void leaveSpan(const ActiveSpan &outer)
+{
+    ThreadBuffer *buffer = currentBuffer();
+    buffer->spanSinceNs.store(outer.sinceNs, std::memory_order_relaxed);
+    buffer->spanName.store(outer.name, std::memory_order_release);
+}
+
+} // namespace
+
+Scope::Scope(const char *name)
+    : m_name(name), m_beginNs(nowNs()), m_outer(enterSpan(name, m_beginNs))
+{
+}
+
+Scope::Scope(const char *name, const QString &detail)
+    : m_name(name), m_detail(detail.toUtf8()), m_beginNs(nowNs()), m_outer(enterSpan(name, m_beginNs))
+{
+}
+
+Scope::~Scope()
+{
+    append(m_name, m_detail.constData(), int(m_detail.size()), m_beginNs, nowNs() - m_beginNs);
+    leaveSpan(m_outer);
+}
+
+ActiveSpan activeSpan(Qt::HANDLE threadId)
+{
+    // Newest first: ids of finished threads get reused
+    QMutexLocker locker(&registryMutex);
+    for (int i = int(registry.size()) - 1; i >= 0; --i) {
+        const ThreadBuffer *buffer = registry[i];
+        if (buffer->threadId == threadId) {
+            ActiveSpan span;
+            span.name = buffer->spanName.load(std::memory_order_acquire);
+            span.sinceNs = buffer->spanSinceNs.load(std::memory_order_relaxed);
+            return span;
+        }
+    }
+    return ActiveSpan();
+}
+
+bool writeJson(const QString &fileName, QString *error)
+{
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+
+    QList<ThreadBuffer *> buffers;
+    {
+        QMutexLocker locker(&registryMutex);
+        buffers = registry;
+    }
+
+    const QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+    QByteArray out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    for (ThreadBuffer *buffer : std::as_const(buffers)) {
+        const QByteArray tid = QByteArray::number(buffer->index);
+        out += first ? "" : ",\n";
+        out += "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" + pid + ",\"tid\":" + tid + ",\"args\":{\"name\":";
+        appendJsonString(out, buffer->threadName.constData());
+        out += "}}";
+        first = false;
+
+        // Complete ("X") events in microseconds since the process started tracing
+        for (Chunk *chunk = buffer->head; chunk; chunk = chunk->next.load(std::memory_order_acquire)) {
+            const int count = chunk->count.load(std::memory_order_acquire);
+            for (int i = 0; i < count; ++i) {
+                const Event &event = chunk->events[i];
+                out += ",\n{\"ph\":\"X\",\"cat\":\"proball\",\"name\":";
+                appendJsonString(out, event.name);
+                out += ",\"pid\":" + pid + ",\"tid\":" + tid;
+                out += ",\"ts\":" + QByteArray::number((event.beginNs - originNs) / 1000.0, 'f', 3);
+                out += ",\"dur\":" + QByteArray::number(event.durationNs / 1000.0, 'f', 3);
+                if (event.detail[0]) {
+                    out += ",\"args\":{\"detail\":";
+                    appendJsonString(out, event.detail);
+                    out += '}';
+                }
+                out += '}';
+            }
+            if (out.size() > (1 << 20)) {
+                file.write(out);
+                out.clear();
+            }
+        }
+
+        const qint64 dropped = buffer->dropped.load(std::memory_order_relaxed);
+        if (dropped > 0)
+            qDebug() << "Trace buffer of thread" << buffer->threadName << "dropped" << dropped << "spans";
+    }
+    out += "\n]}\n";
+    file.write(out);
+
+    if (!file.commit()) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+void writeFromEnvironment()
+{
+    const QString fileName = qEnvironmentVariable("PROBALL_TRACE_FILE");
+    if (fileName.isEmpty())
+        return;
+    QString error;
+    if (writeJson(fileName, &error))
+        qDebug() << "Trace written to" << fileName;
+    else
+        qDebug() << "Failed to write trace:" << error;
+}
+
+} // namespace Trace
+
+#endif // PROBALL_TRACING
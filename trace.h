@@ -0,0 +1,78 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QString>
+
+// Scoped trace spans for finding where wall time goes. Build with
+//   qmake CONFIG+=tracing
+// to compile them in; otherwise every PB_TRACE_* macro expands to nothing
+// and its arguments are never evaluated.
+//
+// Each thread records into its own append-only buffer, so a span costs two
+// clock reads and a few stores, with no lock. The buffers are written as
+// Chrome trace-event JSON (open it in ui.perfetto.dev) to the file named by
+// PROBALL_TRACE_FILE at exit, or on demand from Tools > Save Trace.
+//
+//   PB_TRACE_SCOPE("simulation.tick");
+//   PB_TRACE_SCOPE_DETAIL("sql.exec", m_label);
+
+#ifdef PROBALL_TRACING
+
+#include <QByteArray>
+#include <QThread>
+
+namespace Trace {
+
+qint64 nowNs();
+
+// Records a span measured elsewhere; name must be a string literal
+void complete(const char *name, const QString &detail, qint64 beginNs, qint64 durationNs);
+
+bool writeJson(const QString &fileName, QString *error = nullptr);
+void writeFromEnvironment();
+
+// Innermost open span of a thread, for stall reports
+struct ActiveSpan
+{
+    const char *name = nullptr;
+    qint64 sinceNs = 0;
+};
+
+// Safe to call from any thread; name is null when the thread has no open
+// span. Read while the thread runs, so name and start may briefly disagree.
+ActiveSpan activeSpan(Qt::HANDLE threadId);
+
+class Scope
+{
+public:
+    explicit Scope(const char *name);
+    Scope(const char *name, const QString &detail);
+    ~Scope();
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+private:
+    const char *m_name;
+    QByteArray m_detail;
+    qint64 m_beginNs;
+    ActiveSpan m_outer;
+};
+
+} // namespace Trace
+
+#define PB_TRACE_CONCAT_(a, b) a##b
+#define PB_TRACE_CONCAT(a, b) PB_TRACE_CONCAT_(a, b)
+#define PB_TRACE_SCOPE(name) Trace::Scope PB_TRACE_CONCAT(pbTraceScope, __LINE__)(name)
+#define PB_TRACE_SCOPE_DETAIL(name, detail) Trace::Scope PB_TRACE_CONCAT(pbTraceScope, __LINE__)(name, detail)
+#define PB_TRACE_COMPLETE(name, detail, beginNs, durationNs) Trace::complete(name, detail, beginNs, durationNs)
+
+#else
+
+#define PB_TRACE_SCOPE(name) do {} while (false)
+#define PB_TRACE_SCOPE_DETAIL(name, detail) do {} while (false)
+#define PB_TRACE_COMPLETE(name, detail, beginNs, durationNs) do {} while (false)
+
+#endif // PROBALL_TRACING
+
+#endif // TRACE_H
@@ -0,0 +1,345 @@
+#include "virtualgate.h"
+#include <QDebug>
+#include <QRegularExpression>
+#include <QSocketNotifier>
+#include <QTextStream>
+#include <QTimer>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+using namespace BarrierProtocol;
+
+VirtualGate::VirtualGate(const QString &gateId, int lanes, QObject *parent)
+    : QObject(parent), m_gateId(gateId), m_lanes(qBound(1, lanes, 255)), m_master(-1), m_slaveHold(-1),
+      m_notifier(nullptr), m_legacy(false), m_random(QRandomGenerator::securelySeeded()),
+      m_turnstileTimer(nullptr), m_turnstileRate(0), m_telemetrySeq(0),
+      m_capacity(-1), m_haveCapacitySeq(false), m_capacitySeq(0),
+      m_framesReceived(0), m_corruptReceived(0), m_faultsInjected(0)
+{
+    m_clock.start();
+}
+
+VirtualGate::~VirtualGate()
+{
+    close();
+}
+
+bool VirtualGate::open(const QString &linkPath, QString *error)
+{
+    m_linkPath = linkPath;
+    return openPty(error);
+}
+
+void VirtualGate::close()
+{
+    closePty();
+    if (!m_linkPath.isEmpty())
+        QFile::remove(m_linkPath);
+    m_recording.close();
+}
+
+QString VirtualGate::portName() const
+{
+    return m_linkPath.isEmpty() ? m_slavePath : m_linkPath;
+}
+
+bool VirtualGate::openPty(QString *error)
+{
+    const int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        if (error)
+            *error = QString("Cannot create a pseudo-terminal: %1").arg(strerror(errno));
+        if (master >= 0)
+            ::close(master);
+        return false;
+    }
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+    m_master = master;
+    m_slavePath = QString::fromLocal8Bit(ptsname(master));
+
+    // Holding the slave open keeps the master from reporting a hangup
+    // whenever the host closes and reopens the port
+    m_slaveHold = ::open(ptsname(master), O_RDWR | O_NOCTTY);
+    termios settings;
+    if (m_slaveHold >= 0 && tcgetattr(m_slaveHold, &settings) == 0) {
+        // No echo or newline translation even before the host configures the port
+        cfmakeraw(&settings);
+        tcsetattr(m_slaveHold, TCSANOW, &settings);
+    }
+
+    if (!m_linkPath.isEmpty()) {
+        QFile::remove(m_linkPath);
+        if (!QFile::link(m_slavePath, m_linkPath)) {
+            if (error)
+                *error = "Cannot create link " + m_linkPath;
+            closePty();
+            return false;
+        }
+    }
+
+    m_notifier = new QSocketNotifier(m_master, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &VirtualGate::readMaster);
+    m_decoder.clear();
+    m_lineBuffer.clear();
+    qDebug() << "Virtual gate" << m_gateId << "listening on" << portName();
+    return true;
+}
+
+void VirtualGate::closePty()
+{
+    delete m_notifier;
+    m_notifier = nullptr;
+    if (m_slaveHold >= 0)
+        ::close(m_slaveHold);
+    if (m_master >= 0)
+        ::close(m_master);
+    m_slaveHold = -1;
+    m_master = -1;
+}
+
+void VirtualGate::setTurnstileRate(int entriesPerSecond)
+{
+    m_turnstileRate = qMax(0, entriesPerSecond);
+    if (!m_turnstileTimer) {
+        m_turnstileTimer = new QTimer(this);
+        m_turnstileTimer->setInterval(100);
+        connect(m_turnstileTimer, &QTimer::timeout, this, &VirtualGate::sendTelemetry);
+    }
+    if (m_turnstileRate > 0)
+        m_turnstileTimer->start();
+    else
+        m_turnstileTimer->stop();
+}
+
+void VirtualGate::sendTelemetry()
+{
+    // Legacy firmware never reported counts
+    if (m_legacy || m_master < 0)
+        return;
+
+    // Bursty arrivals around the mean, with one exit for every ten entries
+    const int mean = m_turnstileRate / 10;
+    const int entries = mean > 0 ? m_random.bounded(mean / 2, mean + mean / 2 + 1) : m_random.bounded(2);
+    const int exits = m_random.bounded(entries / 5 + 1);
+    reply(telemetryFrame(m_telemetrySeq++, entries, exits));
+}
+
+bool VirtualGate::startRecording(const QString &fileName, QString *error)
+{
+    m_recording.setFileName(fileName);
+    if (!m_recording.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        if (error)
+            *error = "Cannot write recording: " + m_recording.errorString();
+        return false;
+    }
+    m_clock.restart();
+    return true;
+}
+
+void VirtualGate::record(const char *direction, const QByteArray &bytes)
+{
+    // One line per frame: milliseconds, direction, hex bytes
+    if (!m_recording.isOpen())
+        return;
+    QTextStream(&m_recording) << m_clock.elapsed() << '\t' << direction << '\t' << bytes.toHex() << '\n';
+}
+
+bool VirtualGate::roll(double rate)
+{
+    return rate > 0.0 && m_random.generateDouble() < rate;
+}
+
+void VirtualGate::readMaster()
+{
+    char buffer[256];
+    QByteArray bytes;
+    for (;;) {
+        const ssize_t count = ::read(m_master, buffer, sizeof(buffer));
+        if (count <= 0)
+            break;
+        bytes.append(buffer, int(count));
+    }
+    if (bytes.isEmpty())
+        return;
+
+    if (m_legacy) {
+        m_lineBuffer.append(bytes);
+        int end;
+        while ((end = m_lineBuffer.indexOf('\n')) >= 0) {
+            handleLegacyLine(m_lineBuffer.left(end));
+            m_lineBuffer.remove(0, end + 1);
+        }
+        return;
+    }
+
+    m_decoder.feed(bytes);
+    const QList<Decoder::Result> results = m_decoder.takeFrames();
+    for (const Decoder::Result &result : results) {
+        if (m_master < 0)
+            return; // unplugged while handling an earlier frame
+        if (result.corrupt) {
+            m_corruptReceived++;
+            Frame nack;
+            nack.seq = result.frame.seq;
+            nack.type = Nack;
+            nack.payload.append(char(BadChecksum));
+            reply(nack);
+            continue;
+        }
+        handleFrame(result.frame);
+    }
+}
+
+void VirtualGate::handleFrame(const Frame &frame)
+{
+    record("in", encode(frame));
+    m_framesReceived++;
+
+    if (m_faults.disconnectAfter > 0 && m_framesReceived % m_faults.disconnectAfter == 0) {
+        // Unplug: the host sees the port fail, then the link comes back on a new pty
+        m_faultsInjected++;
+        closePty();
+        emit disconnected();
+        QTimer::singleShot(m_faults.reconnectDelayMs, this, [this]() {
+            if (openPty(nullptr))
+                emit reconnected();
+        });
+        return;
+    }
+
+    Frame answer;
+    answer.seq = frame.seq;
+    answer.type = Ack;
+
+    if (roll(m_faults.corruptRate)) {
+        // Pretend the frame arrived damaged
+        m_faultsInjected++;
+        answer.type = Nack;
+        answer.payload.append(char(BadChecksum));
+        reply(answer);
+        return;
+    }
+
+    switch (frame.type) {
+    case Hello:
+        answer.payload.append(char(CurrentVersion));
+        answer.payload.append(char(m_lanes));
+        answer.payload.append(m_gateId.toUtf8().left(MaxPayload - 2));
+        break;
+    case SetCapacity: {
+        const int capacity = capacityFromPayload(frame.payload);
+        if (capacity < 0) {
+            answer.type = Nack;
+            answer.payload.append(char(BadPayload));
+            break;
+        }
+        // Retransmits of older capacities are acked but not applied
+        if (!m_haveCapacitySeq || seqNewer(frame.seq, m_capacitySeq)) {
+            m_haveCapacitySeq = true;
+            m_capacitySeq = frame.seq;
+            m_capacity = capacity;
+            emit capacityApplied(capacity);
+        }
+        break;
+    }
+    case Reset:
+        emit resetApplied();
+        break;
+    default:
+        answer.type = Nack;
+        answer.payload.append(char(UnknownType));
+        break;
+    }
+    reply(answer);
+}
+
+void VirtualGate::handleLegacyLine(const QByteArray &line)
+{
+    // Hello frames from the host land here too; only the tail of a line counts
+    static const QRegularExpression command("(?:C(\\d+)|R)\\r?$");
+    const QRegularExpressionMatch match = command.match(QString::fromLatin1(line));
+    record("in", line + '\n');
+    m_framesReceived++;
+    if (!match.hasMatch())
+        return;
+
+    if (match.captured(1).isEmpty()) {
+        emit resetApplied();
+    } else {
+        m_capacity = match.captured(1).toInt();
+        emit capacityApplied(m_capacity);
+    }
+}
+
+void VirtualGate::reply(const Frame &frame)
+{
+    if (roll(m_faults.dropRate)) {
+        m_faultsInjected++;
+        return;
+    }
+
+    QByteArray bytes = encode(frame);
+    if (roll(m_faults.corruptRate)) {
+        m_faultsInjected++;
+        const int index = 1 + m_random.bounded(int(bytes.size()) - 1);
+        bytes[index] = char(bytes[index] ^ (1 << m_random.bounded(8)));
+    }
+
+    const int delay = m_faults.latencyMs + (m_faults.jitterMs > 0 ? m_random.bounded(m_faults.jitterMs + 1) : 0);
+    if (delay <= 0) {
+        writeMaster(bytes);
+        return;
+    }
+    QTimer::singleShot(delay, Qt::PreciseTimer, this, [this, bytes]() {
+        writeMaster(bytes);
+    });
+}
+
+void VirtualGate::writeMaster(const QByteArray &bytes)
+{
+    if (m_master < 0)
+        return; // unplugged in the meantime
+    record("out", bytes);
+    if (::write(m_master, bytes.constData(), size_t(bytes.size())) < 0)
+        qDebug() << "Virtual gate write failed:" << strerror(errno);
+}
+
+QList<VirtualGate::RecordedCommand> VirtualGate::loadRecording(const QString &fileName, QString *error)
+{
+    QList<RecordedCommand> commands;
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        if (error)
+            *error = "Cannot read recording: " + file.errorString();
+        return commands;
+    }
+
+    qint64 firstMs = -1;
+    while (!file.atEnd()) {
+        const QList<QByteArray> fields = file.readLine().trimmed().split('\t');
+        if (fields.size() != 3 || fields[1] != "in")
+            continue;
+        const qint64 atMs = fields[0].toLongLong();
+        if (firstMs < 0)
+            firstMs = atMs;
+
+        const QByteArray bytes = QByteArray::fromHex(fields[2]);
+        if (!bytes.isEmpty() && quint8(bytes[0]) == StartOfFrame) {
+            Decoder decoder;
+            decoder.feed(bytes);
+            for (const Decoder::Result &result : decoder.takeFrames()) {
+                if (!result.corrupt && (result.frame.type == SetCapacity || result.frame.type == Reset))
+                    commands.append({atMs - firstMs, result.frame});
+            }
+        } else if (bytes.startsWith('C')) {
+            commands.append({atMs - firstMs, capacityFrame(0, bytes.mid(1).trimmed().toInt())});
+        } else if (bytes.startsWith('R')) {
+            commands.append({atMs - firstMs, resetFrame(0)});
+        }
+    }
+    return commands;
+}
@@ -0,0 +1,109 @@
+#ifndef VIRTUALGATE_H
+#define VIRTUALGATE_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QString>
+#include "barrierprotocol.h"
+
+class QSocketNotifier;
+class QTimer;
+
+// A gate controller in software, behind a pseudo-terminal (Unix only). The
+// host side opens portName() like any serial port. The gate answers Hello
+// with its id and lanes, acks or nacks frames exactly like the firmware
+// should, and can inject faults to exercise the retransmit and reconnect
+// paths. With a link path it keeps a symlink pointing at the current pty,
+// so a simulated unplug/replug is seen as the same port.
+class VirtualGate : public QObject
+{
+    Q_OBJECT
+public:
+    struct Faults
+    {
+        int latencyMs = 0;          // delay before each reply
+        int jitterMs = 0;           // extra random delay, 0..jitterMs
+        double corruptRate = 0.0;   // chance a frame is damaged, each direction
+        double dropRate = 0.0;      // chance a reply is lost
+        int disconnectAfter = 0;    // unplug after this many frames; 0 never
+        int reconnectDelayMs = 1000;
+    };
+
+    VirtualGate(const QString &gateId, int lanes, QObject *parent = nullptr);
+    ~VirtualGate();
+
+    bool open(const QString &linkPath = QString(), QString *error = nullptr);
+    void close();
+    QString portName() const;
+
+    void setFaults(const Faults &faults) { m_faults = faults; }
+    void setLegacy(bool legacy) { m_legacy = legacy; }
+    void setSeed(quint32 seed) { m_random.seed(seed); }
+
+    // Streams turnstile counts at about this many entries per second
+    void setTurnstileRate(int entriesPerSecond);
+
+    // Log of every frame in both directions, replayable by gate-bench
+    bool startRecording(const QString &fileName, QString *error = nullptr);
+
+    int capacity() const { return m_capacity; }
+    int framesReceived() const { return m_framesReceived; }
+    int corruptFramesReceived() const { return m_corruptReceived; }
+    int faultsInjected() const { return m_faultsInjected; }
+
+    // Host-to-gate commands of a recording, with their offsets in milliseconds
+    struct RecordedCommand
+    {
+        qint64 atMs;
+        BarrierProtocol::Frame frame;
+    };
+    static QList<RecordedCommand> loadRecording(const QString &fileName, QString *error = nullptr);
+
+signals:
+    void capacityApplied(int capacity);
+    void resetApplied();
+    void disconnected();
+    void reconnected();
+
+private slots:
+    void readMaster();
+    void sendTelemetry();
+
+private:
+    bool openPty(QString *error);
+    void closePty();
+    void handleFrame(const BarrierProtocol::Frame &frame);
+    void handleLegacyLine(const QByteArray &line);
+    void reply(const BarrierProtocol::Frame &frame);
+    void writeMaster(const QByteArray &bytes);
+    void record(const char *direction, const QByteArray &bytes);
+    bool roll(double rate);
+
+    QString m_gateId;
+    int m_lanes;
+    int m_master;
+    int m_slaveHold;
+    QSocketNotifier *m_notifier;
+    QString m_slavePath;
+    QString m_linkPath;
+    BarrierProtocol::Decoder m_decoder;
+    QByteArray m_lineBuffer;
+    Faults m_faults;
+    bool m_legacy;
+    QRandomGenerator m_random;
+    QFile m_recording;
+    QElapsedTimer m_clock;
+    QTimer *m_turnstileTimer;
+    int m_turnstileRate;
+    quint8 m_telemetrySeq;
+    int m_capacity;
+    bool m_haveCapacitySeq;
+    quint8 m_capacitySeq; // last applied capacity, older ones are ignored
+    int m_framesReceived;
+    int m_corruptReceived;
+    int m_faultsInjected;
+};
+
+#endif // VIRTUALGATE_H